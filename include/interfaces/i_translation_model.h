@@ -54,6 +54,26 @@ public:
      */
     virtual std::future<TranslationResult> translateAsync(const std::string& text, const TranslationOptions& options) = 0;
 
+    /**
+     * @brief Translate text, reporting the output as it is generated
+     *
+     * Models that cannot stream report the whole translation in a single call once it
+     * is complete, which is what this default implementation does.
+     *
+     * @param text The input text to translate
+     * @param options Translation options and parameters
+     * @param callback Receives each newly generated piece of text, returns false to stop
+     * @return TranslationResult The translation result, with the text generated until stopped
+     */
+    virtual TranslationResult translateStream(const std::string& text, const TranslationOptions& options,
+                                              const TranslationStreamCallback& callback) {
+        TranslationResult result = translate(text, options);
+        if (result.success && callback && !result.text.empty()) {
+            callback(result.text);
+        }
+        return result;
+    }
+
     /**
      * @brief Get information about the loaded model
      * @return ModelInfo Information about the model including name, version, and type
@@ -0,0 +1,466 @@
+/**
+ * @file batch_scheduler.cc
+ * @brief Implementation of the continuous batching scheduler
+ */
+
+#include "inference/batch_scheduler.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <limits>
+
+namespace koebridge {
+namespace inference {
+
+namespace {
+
+int greedyToken(LogitsSpan logits) {
+    if (logits.empty()) {
+        return -1;
+    }
+    return static_cast<int>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+}
+
+// Set the logits of every evaluated token outside a row's own shortlist to -infinity.
+// Both lists are sorted, so one merge walk finds them. Without an evaluated list the
+// pass covered the whole vocabulary, and every token outside the shortlist is masked.
+void maskToShortlist(LogitsSpan logits, const std::vector<int>* evaluated, const std::vector<int>& own) {
+    const float kMasked = -std::numeric_limits<float>::infinity();
+    auto ownIt = own.begin();
+    auto mask = [&](int token) {
+        while (ownIt != own.end() && *ownIt < token) {
+            ++ownIt;
+        }
+        if ((ownIt == own.end() || *ownIt != token) && static_cast<size_t>(token) < logits.size) {
+            logits[token] = kMasked;
+        }
+    };
+
+    if (evaluated) {
+        for (int token : *evaluated) {
+            mask(token);
+        }
+    } else {
+        for (size_t token = 0; token < logits.size; ++token) {
+            mask(static_cast<int>(token));
+        }
+    }
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+BatchScheduler::BatchScheduler(InferenceEngine& engine, size_t maxBatchSize)
+    : engine_(engine), maxBatchSize_(std::max<size_t>(1, maxBatchSize)) {
+}
+
+BatchScheduler::~BatchScheduler() {
+    stop();
+}
+
+void BatchScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&BatchScheduler::run, this);
+}
+
+void BatchScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Fail whatever never got to run
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& sequence : pending_) {
+        sequence.admittedAt = Clock::now();
+        finish(sequence, false, "Batch scheduler stopped");
+    }
+    pending_.clear();
+}
+
+bool BatchScheduler::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+std::future<SequenceResult> BatchScheduler::submit(SequenceRequest request) {
+    std::vector<SequenceRequest> requests;
+    requests.push_back(std::move(request));
+    return std::move(submitAll(std::move(requests)).front());
+}
+
+std::vector<std::future<SequenceResult>> BatchScheduler::submitAll(std::vector<SequenceRequest> requests) {
+    std::vector<std::future<SequenceResult>> futures;
+    futures.reserve(requests.size());
+    std::vector<Sequence> sequences;
+    sequences.reserve(requests.size());
+
+    const Clock::time_point now = Clock::now();
+    for (SequenceRequest& request : requests) {
+        Sequence sequence;
+        sequence.tokens = request.promptTokens;
+        sequence.request = std::move(request);
+        sequence.submittedAt = now;
+        futures.push_back(sequence.promise.get_future());
+
+        if (sequence.tokens.empty()) {
+            sequence.admittedAt = sequence.submittedAt;
+            finish(sequence, false, "Empty prompt");
+            continue;
+        }
+        sequences.push_back(std::move(sequence));
+    }
+    if (sequences.empty()) {
+        return futures;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            for (Sequence& sequence : sequences) {
+                sequence.admittedAt = sequence.submittedAt;
+                finish(sequence, false, "Batch scheduler not running");
+            }
+            return futures;
+        }
+        for (Sequence& sequence : sequences) {
+            pending_.push_back(std::move(sequence));
+        }
+        stats_.sequencesPending = pending_.size();
+    }
+    cv_.notify_one();
+
+    return futures;
+}
+
+SchedulerStats BatchScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BatchScheduler::run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return !running_ || !pending_.empty() || !active_.empty();
+            });
+
+            if (!running_) {
+                break;
+            }
+
+            // Refill free batch slots before every iteration, dropping what expired while waiting
+            while (active_.size() < maxBatchSize_ && !pending_.empty()) {
+                Sequence sequence = std::move(pending_.front());
+                pending_.pop_front();
+                sequence.admittedAt = Clock::now();
+                if (interruptIfStopped(sequence)) {
+                    stats_.sequencesInterrupted++;
+                    continue;
+                }
+                active_.push_back(std::move(sequence));
+            }
+            stats_.sequencesPending = pending_.size();
+            stats_.sequencesActive = active_.size();
+        }
+
+        step();
+    }
+
+    for (auto& sequence : active_) {
+        finish(sequence, false, "Batch scheduler stopped");
+    }
+    active_.clear();
+}
+
+void BatchScheduler::step() {
+    if (active_.empty()) {
+        return;
+    }
+
+    // Stopped sequences leave before the forward pass, keeping what they generated so far
+    size_t interrupted = 0;
+    for (auto& sequence : active_) {
+        if (interruptIfStopped(sequence)) {
+            ++interrupted;
+        }
+    }
+    if (interrupted > 0) {
+        active_.erase(std::remove_if(active_.begin(), active_.end(), [](const Sequence& sequence) {
+            return sequence.tokens.empty();
+        }), active_.end());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.sequencesInterrupted += interrupted;
+        stats_.sequencesActive = active_.size();
+    }
+    if (active_.empty()) {
+        return;
+    }
+
+    proposeDrafts();
+
+    // The engine keeps no KV cache yet, so each row only needs its newest token.
+    // A sequence's rows are its last token followed by its draft proposal.
+    std::vector<int> rows;
+    std::vector<size_t> firstRow;
+    rows.reserve(active_.size());
+    firstRow.reserve(active_.size());
+    for (auto& sequence : active_) {
+        firstRow.push_back(rows.size());
+        rows.push_back(sequence.tokens.back());
+        rows.insert(rows.end(), sequence.draft.begin(), sequence.draft.end());
+    }
+
+    // Restrict the output projection only if no sequence needs the full vocabulary
+    const std::vector<int>* shortlist = nullptr;
+    bool restricted = true;
+    for (const auto& sequence : active_) {
+        const auto& own = sequence.request.shortlist;
+        if (!own) {
+            restricted = false;
+            break;
+        }
+        if (!shortlist) {
+            shortlist = own.get();
+        } else if (shortlist != own.get()) {
+            if (shortlist != &shortlist_) {
+                shortlist_.assign(shortlist->begin(), shortlist->end());
+                shortlist = &shortlist_;
+            }
+            shortlist_.insert(shortlist_.end(), own->begin(), own->end());
+        }
+    }
+    if (shortlist == &shortlist_) {
+        std::sort(shortlist_.begin(), shortlist_.end());
+        shortlist_.erase(std::unique(shortlist_.begin(), shortlist_.end()), shortlist_.end());
+    }
+
+    // Every row of a sequence attends to the same source context
+    context_.clear();
+    const size_t dim = engine_.getEmbeddingSize();
+    for (size_t i = 0; i < active_.size(); ++i) {
+        Sequence& sequence = active_[i];
+        const auto& encoderOutput = sequence.request.encoderOutput;
+        if (!encoderOutput || encoderOutput->dim != dim) {
+            continue;
+        }
+        if (sequence.context.empty()) {
+            sequence.context.resize(dim);
+            encoderOutput->attend(sequence.context.data());
+        }
+        if (context_.empty()) {
+            context_.assign(rows.size() * dim, 0.0f);
+        }
+        for (size_t row = firstRow[i]; row <= firstRow[i] + sequence.draft.size(); ++row) {
+            std::copy(sequence.context.begin(), sequence.context.end(), context_.begin() + row * dim);
+        }
+    }
+
+    // Tokens the forward pass computed logits for, null for the full vocabulary
+    const std::vector<int>* evaluatedTokens = restricted ? shortlist : nullptr;
+    const bool evaluated = evaluatedTokens
+        ? engine_.evaluateBatch(rows, *evaluatedTokens, context_)
+        : engine_.evaluateBatch(rows, {}, context_);
+    if (!evaluated) {
+        LOG_ERROR("Batched forward pass failed for " + std::to_string(active_.size()) + " sequences");
+        for (auto& sequence : active_) {
+            finish(sequence, false, "Forward pass failed");
+        }
+        active_.clear();
+        return;
+    }
+
+    size_t completed = 0;
+    size_t generated = 0;
+    size_t proposed = 0;
+    size_t accepted = 0;
+    for (size_t i = 0; i < active_.size(); ++i) {
+        Sequence& sequence = active_[i];
+        const std::vector<int> draft = std::move(sequence.draft);
+        proposed += draft.size();
+
+        // A pass over a union of shortlists or the full vocabulary computes tokens outside
+        // this sequence's shortlist; sampling them would make its output depend on what
+        // else shares the batch, e.g. switch to another request's language
+        const std::vector<int>* own = sequence.request.shortlist.get();
+        const bool masked = own && own != evaluatedTokens;
+        sequence.draftProposed += draft.size();
+
+        // Keep sampling down the rows while the sampled token matches the proposal
+        const int before = sequence.generated;
+        for (size_t j = 0; j <= draft.size(); ++j) {
+            LogitsSpan logits = engine_.getLogitsSpan(firstRow[i] + j);
+            if (masked) {
+                maskToShortlist(logits, evaluatedTokens, *own);
+            }
+            if (!advance(sequence, logits)) {
+                ++completed;
+                break;
+            }
+            if (j == draft.size() || sequence.tokens.back() != draft[j]) {
+                break;
+            }
+            ++accepted;
+            ++sequence.draftAccepted;
+        }
+        generated += sequence.generated - before;
+    }
+
+    active_.erase(std::remove_if(active_.begin(), active_.end(), [](const Sequence& sequence) {
+        return sequence.tokens.empty();
+    }), active_.end());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.decodeSteps++;
+    stats_.rowsDecoded += rows.size();
+    stats_.tokensGenerated += generated;
+    stats_.sequencesCompleted += completed;
+    stats_.sequencesActive = active_.size();
+    stats_.draftTokensProposed += proposed;
+    stats_.draftTokensAccepted += accepted;
+}
+
+void BatchScheduler::proposeDrafts() {
+    std::vector<size_t> group;
+    std::vector<const std::vector<int>*> histories;
+    std::vector<int> budgets;
+    std::vector<bool> proposed(active_.size(), false);
+    for (auto& sequence : active_) {
+        sequence.draft.clear();
+    }
+
+    for (size_t i = 0; i < active_.size(); ++i) {
+        const DraftProposer* draft = active_[i].request.draft.get();
+        if (!draft || proposed[i]) {
+            continue;
+        }
+
+        // Gather every sequence with this proposer that still has room for a proposal
+        group.clear();
+        histories.clear();
+        budgets.clear();
+        for (size_t j = i; j < active_.size(); ++j) {
+            Sequence& sequence = active_[j];
+            if (sequence.request.draft.get() != draft) {
+                continue;
+            }
+            proposed[j] = true;
+            const int budget = std::min(sequence.request.draftTokens,
+                                        sequence.request.maxNewTokens - sequence.generated - 1);
+            if (budget > 0) {
+                group.push_back(j);
+                histories.push_back(&sequence.tokens);
+                budgets.push_back(budget);
+            }
+        }
+        if (group.empty()) {
+            continue;
+        }
+
+        try {
+            std::vector<std::vector<int>> proposals = (*draft)(histories, budgets);
+            for (size_t k = 0; k < group.size() && k < proposals.size(); ++k) {
+                std::vector<int>& tokens = active_[group[k]].draft;
+                tokens = std::move(proposals[k]);
+                if (tokens.size() > static_cast<size_t>(budgets[k])) {
+                    tokens.resize(budgets[k]);
+                }
+            }
+        } catch (const std::exception& e) {
+            LOG_WARNING(std::string("Draft proposal failed: ") + e.what());
+            for (size_t index : group) {
+                active_[index].draft.clear();
+            }
+        }
+    }
+}
+
+bool BatchScheduler::interruptIfStopped(Sequence& sequence) {
+    const auto& cancellation = sequence.request.cancellation;
+    if (!cancellation || !cancellation->shouldStop()) {
+        return false;
+    }
+    sequence.interrupted = true;
+    finish(sequence, false, cancellation->stopReason());
+    return true;
+}
+
+bool BatchScheduler::advance(Sequence& sequence, LogitsSpan logits) {
+    int nextToken = -1;
+    try {
+        nextToken = sequence.request.sampler
+            ? sequence.request.sampler(logits, sequence.tokens)
+            : greedyToken(logits);
+    } catch (const std::exception& e) {
+        finish(sequence, false, std::string("Sampling error: ") + e.what());
+        return false;
+    }
+
+    if (nextToken < 0) {
+        finish(sequence, false, "Sampler returned no token");
+        return false;
+    }
+
+    sequence.tokens.push_back(nextToken);
+    ++sequence.generated;
+
+    // Streaming consumers see the token right away and may stop the sequence
+    bool stopped = false;
+    if (sequence.request.onToken) {
+        try {
+            stopped = !sequence.request.onToken(nextToken);
+        } catch (const std::exception& e) {
+            finish(sequence, false, std::string("Token callback error: ") + e.what());
+            return false;
+        }
+    }
+
+    if (stopped || nextToken == sequence.request.eosToken ||
+        sequence.generated >= sequence.request.maxNewTokens) {
+        finish(sequence, true);
+        return false;
+    }
+    return true;
+}
+
+void BatchScheduler::finish(Sequence& sequence, bool success, const std::string& errorMessage) {
+    auto now = Clock::now();
+
+    SequenceResult result;
+    result.success = success;
+    result.errorMessage = errorMessage;
+    result.interrupted = sequence.interrupted;
+    result.tokens = std::move(sequence.tokens);
+    result.queueTimeMs = elapsedMs(sequence.submittedAt, sequence.admittedAt);
+    result.decodeTimeMs = elapsedMs(sequence.admittedAt, now);
+    result.draftTokensProposed = sequence.draftProposed;
+    result.draftTokensAccepted = sequence.draftAccepted;
+
+    // A moved-from token list marks the slot as retired
+    sequence.tokens.clear();
+    if (sequence.request.onComplete) {
+        sequence.request.onComplete(std::move(result));
+    } else {
+        sequence.promise.set_value(std::move(result));
+    }
+}
+
+} // namespace inference
+} // namespace koebridge
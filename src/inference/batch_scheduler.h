@@ -0,0 +1,261 @@
+/**
+ * @file batch_scheduler.h
+ * @brief Iteration-level (continuous batching) scheduler in front of the inference engine
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include "inference/engine.h"
+#include "utils/cancellation_token.h"
+
+namespace koebridge {
+namespace inference {
+
+/**
+ * @typedef TokenSampler
+ * @brief Picks the next token for a sequence from its logits and token history
+ *
+ * The logits are a view into the engine and may be modified in place.
+ */
+using TokenSampler = std::function<int(LogitsSpan logits, const std::vector<int>& history)>;
+
+/**
+ * @typedef DraftProposer
+ * @brief Guesses up to a number of tokens that follow each of several sequence histories
+ *
+ * Used for speculative decoding: a cheaper draft model proposes the tokens for every
+ * sequence sharing it in one batched decode, and the engine checks them all in the
+ * sequences' next forward pass.
+ */
+using DraftProposer = std::function<std::vector<std::vector<int>>(
+    const std::vector<const std::vector<int>*>& histories, const std::vector<int>& maxTokens)>;
+
+/**
+ * @struct SequenceResult
+ * @brief Result of a sequence generated by the batch scheduler
+ */
+struct SequenceResult {
+    std::vector<int> tokens;           ///< Prompt tokens followed by generated tokens
+    bool success = false;              ///< Whether generation was successful
+    std::string errorMessage;          ///< Error message if generation failed
+    bool interrupted = false;          ///< Cancelled or timed out, tokens hold the partial output
+    double queueTimeMs = 0.0;          ///< Time spent waiting for a batch slot
+    double decodeTimeMs = 0.0;         ///< Time spent in the running batch
+    size_t draftTokensProposed = 0;    ///< Tokens proposed by the draft
+    size_t draftTokensAccepted = 0;    ///< Proposed tokens that matched the sampled ones
+};
+
+/**
+ * @struct SequenceRequest
+ * @brief A single generation request submitted to the batch scheduler
+ */
+struct SequenceRequest {
+    std::vector<int> promptTokens;     ///< Tokens the sequence starts from
+    int maxNewTokens = 256;            ///< Maximum number of tokens to generate
+    int eosToken = 2;                  ///< Token that terminates the sequence
+    TokenSampler sampler;              ///< Sampling function (greedy if empty)
+    TokenCallback onToken;             ///< Called on the scheduler thread with each new token
+    std::shared_ptr<const DraftProposer> draft; ///< Speculative draft proposer, batched per instance (none if null)
+    int draftTokens = 4;               ///< Tokens the draft proposes per iteration
+    std::shared_ptr<const std::vector<int>> shortlist; ///< Sorted output token IDs (full vocabulary if null)
+    std::shared_ptr<const EncoderOutput> encoderOutput; ///< Source states the decoder attends to (none if null)
+    std::shared_ptr<const utils::CancellationToken> cancellation; ///< Checked between decode steps (never stops if null)
+    std::function<void(SequenceResult)> onComplete; ///< Receives the result on the scheduler thread instead of the future, must not block
+};
+
+/**
+ * @struct SchedulerStats
+ * @brief Aggregate statistics of the batch scheduler
+ */
+struct SchedulerStats {
+    size_t decodeSteps = 0;            ///< Number of batched forward passes
+    size_t rowsDecoded = 0;            ///< Sequence rows over all forward passes
+    size_t tokensGenerated = 0;        ///< Total tokens generated over all sequences
+    size_t sequencesCompleted = 0;     ///< Number of finished sequences
+    size_t sequencesInterrupted = 0;   ///< Sequences stopped by cancellation or deadline
+    size_t sequencesPending = 0;       ///< Sequences waiting for a batch slot
+    size_t sequencesActive = 0;        ///< Sequences in the running batch
+    size_t draftTokensProposed = 0;    ///< Tokens proposed by draft models
+    size_t draftTokensAccepted = 0;    ///< Proposed tokens that were accepted
+
+    /**
+     * @brief Average number of sequences decoded per forward pass
+     * @return double Average batch occupancy
+     */
+    double averageBatchSize() const {
+        return decodeSteps == 0 ? 0.0 : static_cast<double>(rowsDecoded) / decodeSteps;
+    }
+
+    /**
+     * @brief Fraction of draft tokens that were accepted
+     * @return double Acceptance rate, 0 if nothing was proposed
+     */
+    double draftAcceptanceRate() const {
+        return draftTokensProposed == 0 ? 0.0 : static_cast<double>(draftTokensAccepted) / draftTokensProposed;
+    }
+};
+
+/**
+ * @class BatchScheduler
+ * @brief Runs concurrent generation requests as one continuously refilled decode batch
+ *
+ * Every iteration the scheduler runs a single batched forward pass over all active
+ * sequences, samples one token per sequence and retires the sequences that finished.
+ * Freed slots are refilled from the pending queue before the next iteration, so new
+ * requests join the running batch instead of waiting for it to drain.
+ *
+ * Sequences with a draft proposer add the proposed tokens as extra rows of the same
+ * forward pass. Row j then holds the logits after the j-th proposed token, so the
+ * sampled tokens are checked against the proposal in order and every match up to the
+ * first mismatch is kept: the output is exactly what plain decoding would sample, in
+ * fewer iterations. Sequences sharing a draft proposer get their proposals from one
+ * batched call to it.
+ *
+ * When every active sequence has an output shortlist, the forward pass computes logits
+ * over the union of their shortlists only. Rows of a sequence with a shortlist are
+ * always masked to that shortlist before sampling, whatever else shares the batch.
+ *
+ * Sequences whose cancellation token fires are retired before the next forward pass
+ * with the tokens generated so far, and never admitted if it fires while they wait.
+ */
+class BatchScheduler {
+public:
+    /**
+     * @brief Constructor for BatchScheduler
+     * @param engine Inference engine used for the forward passes
+     * @param maxBatchSize Maximum number of sequences decoded together
+     */
+    BatchScheduler(InferenceEngine& engine, size_t maxBatchSize);
+
+    /**
+     * @brief Destructor, stops the scheduler thread
+     */
+    ~BatchScheduler();
+
+    /**
+     * @brief Start the scheduler thread
+     */
+    void start();
+
+    /**
+     * @brief Stop the scheduler thread and fail all unfinished sequences
+     */
+    void stop();
+
+    /**
+     * @brief Check if the scheduler thread is running
+     * @return bool True if running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Submit a sequence for generation
+     * @param request The generation request
+     * @return std::future<SequenceResult> Future completed when the sequence finishes, unless the request has onComplete
+     */
+    std::future<SequenceResult> submit(SequenceRequest request);
+
+    /**
+     * @brief Submit several sequences at once
+     *
+     * The sequences are queued under one lock and the scheduler thread is woken once,
+     * so they are admitted to the same decode step.
+     *
+     * @param requests The generation requests
+     * @return std::vector<std::future<SequenceResult>> One future per request, in order
+     */
+    std::vector<std::future<SequenceResult>> submitAll(std::vector<SequenceRequest> requests);
+
+    /**
+     * @brief Get scheduler statistics
+     * @return SchedulerStats Current statistics
+     */
+    SchedulerStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @struct Sequence
+     * @brief Book-keeping for a sequence owned by the scheduler
+     */
+    struct Sequence {
+        SequenceRequest request;
+        std::vector<int> tokens;
+        int generated = 0;
+        std::vector<int> draft;
+        size_t draftProposed = 0;
+        size_t draftAccepted = 0;
+        std::vector<float> context;
+        std::promise<SequenceResult> promise;
+        bool interrupted = false;
+        Clock::time_point submittedAt;
+        Clock::time_point admittedAt;
+    };
+
+    /**
+     * @brief Scheduler thread main loop
+     */
+    void run();
+
+    /**
+     * @brief Run one decode iteration over the active batch
+     */
+    void step();
+
+    /**
+     * @brief Fill in the draft proposals of the active sequences
+     *
+     * Sequences sharing a proposer are passed to it together, so a draft model decodes
+     * all of their proposals as one batch.
+     */
+    void proposeDrafts();
+
+    /**
+     * @brief Finish a sequence if its cancellation token fired
+     * @param sequence The sequence
+     * @return bool True if the sequence was finished
+     */
+    bool interruptIfStopped(Sequence& sequence);
+
+    /**
+     * @brief Sample one token for a sequence and append it
+     * @param sequence The sequence
+     * @param logits Logits of the row to sample from
+     * @return bool True if the sequence continues, false if it was finished
+     */
+    bool advance(Sequence& sequence, LogitsSpan logits);
+
+    /**
+     * @brief Complete a sequence and fulfil its promise
+     * @param sequence The sequence to complete
+     * @param success Whether generation succeeded
+     * @param errorMessage Error message on failure
+     */
+    void finish(Sequence& sequence, bool success, const std::string& errorMessage = "");
+
+    InferenceEngine& engine_;                  ///< Engine running the forward passes
+    size_t maxBatchSize_;                      ///< Maximum active sequences
+    std::deque<Sequence> pending_;             ///< Sequences waiting for a batch slot
+    std::vector<Sequence> active_;             ///< Sequences in the running batch
+    std::vector<int> shortlist_;               ///< Union of the active shortlists, scheduler thread only
+    std::vector<float> context_;               ///< Per-row source context, scheduler thread only
+    SchedulerStats stats_;                     ///< Aggregate statistics
+    mutable std::mutex mutex_;                 ///< Guards pending_ and stats_
+    std::condition_variable cv_;               ///< Signals new work or shutdown
+    std::thread thread_;                       ///< Scheduler thread
+    bool running_ = false;                     ///< Scheduler running flag
+};
+
+} // namespace inference
+} // namespace koebridge
@@ -2,24 +2,55 @@
 #include "utils/config.h"
 #include "utils/logger.h"
 #include "translation/data_structures.h"
+#include "inference/gguf_model_file.h"
+#include "inference/gguf_keys.h"
 #include <ggml.h>
 #include <ggml-backend.h>
 #include <ggml-cpu.h>
+#include <sentencepiece_processor.h>
 #include <fstream>
 #include <iostream>
 #include <chrono>
 #include <stdexcept>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <string_view>
 #include <cstring>
+#include <cctype>
+#include <filesystem>
+#include <limits>
+#include <cmath>
 
 namespace koebridge {
 namespace inference {
 
+namespace {
+
+// FNV-1a over the token IDs of a source sentence
+struct TokenSequenceHash {
+    size_t operator()(const std::vector<int>& tokens) const {
+        uint64_t hash = 1469598103934665603ULL;
+        for (int token : tokens) {
+            hash ^= static_cast<uint32_t>(token);
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+} // namespace
+
 class InferenceEngine::Impl {
 public:
-    Impl() : ctx_(nullptr), model_(nullptr), initialized_(false), logits_(nullptr), vocabSize_(0),
-             tokenizer_(nullptr, [](void*){}) {
+    Impl() : ctx_(nullptr), model_(nullptr), tokEmbd_(nullptr), output_(nullptr), initialized_(false),
+             logits_(nullptr), logitsRows_(0), vocabSize_(0),
+             numThreads_(std::max(1, utils::Config::getInstance().getInt("inference.num_threads", 4))),
+             threadpool_(nullptr),
+             encoderCache_(std::max(0, utils::Config::getInstance().getInt("inference.encoder_cache_size", 256))) {
         // Initialize default special tokens
         specialTokens_ = {
             {"<s>", 1},      // BOS token
@@ -31,6 +62,9 @@ public:
 
     ~Impl() {
         cleanup();
+        if (threadpool_) {
+            ggml_threadpool_free(threadpool_);
+        }
     }
 
     bool initialize(const std::string& modelPath) {
@@ -40,6 +74,10 @@ public:
 
         LOG_INFO("Starting model initialization...");
 
+        if (GGUFModelFile::isGGUF(modelPath)) {
+            return initializeGGUF(modelPath);
+        }
+
         // Initialize GGML context with appropriate size
         LOG_INFO("Initializing GGML context (1GB)...");
         const size_t ctxSize = 1024 * 1024 * 1024; // 1GB initial size
@@ -89,6 +127,7 @@ public:
                 "  - Embedding size: " + std::to_string(n_embd) + "\n" +
                 "  - Vocabulary size: " + std::to_string(vocab_size);
             LOG_INFO(archInfo);
+            vocabSize_ = vocab_size;
 
             // Allocate model tensors
             LOG_INFO("Allocating model tensors...");
@@ -119,21 +158,24 @@ public:
 
             // Load vocabulary
             LOG_INFO("Loading vocabulary (" + std::to_string(vocab_size) + " tokens)...");
-            vocab_.resize(vocab_size);
+            std::vector<std::string> tokens(vocab_size);
             for (size_t i = 0; i < vocab_size; ++i) {
                 uint32_t tokenLength;
                 file.read(reinterpret_cast<char*>(&tokenLength), sizeof(tokenLength));
 
                 std::string token(tokenLength, '\0');
                 file.read(&token[0], tokenLength);
-                vocab_[i] = token;
+                tokens[i] = token;
 
                 if (i % 10000 == 0) {
                     LOG_INFO("Loaded " + std::to_string(i) + "/" + std::to_string(vocab_size) + " tokens");
                 }
             }
+            setVocabulary(tokens);
             LOG_INFO("Vocabulary loaded successfully");
 
+            loadTokenizer(modelPath);
+
             initialized_ = true;
             LOG_INFO("Model initialization completed successfully");
             return true;
@@ -145,6 +187,66 @@ public:
         }
     }
 
+    bool initializeGGUF(const std::string& modelPath) {
+        LOG_INFO("Loading GGUF model: " + modelPath);
+
+        modelFile_ = std::make_unique<GGUFModelFile>();
+        if (!modelFile_->open(modelPath)) {
+            cleanup();
+            return false;
+        }
+
+        architecture_ = modelFile_->getString(gguf_keys::kArchitecture, "unknown");
+
+        // Tensors point straight into the file mapping, quantized weights stay quantized
+        tokEmbd_ = modelFile_->getTensor(gguf_keys::kTokenEmbedding);
+        output_ = modelFile_->getTensor(gguf_keys::kOutput);
+        if (!tokEmbd_) {
+            LOG_ERROR("GGUF model has no token_embd.weight tensor");
+            cleanup();
+            return false;
+        }
+        if (!output_) {
+            // Tied input/output embeddings
+            output_ = tokEmbd_;
+        }
+
+        // Files written by koebridge-quantize carry precomputed lookup tables
+        if (!mapVocabularyTables()) {
+            setVocabulary(modelFile_->getStringArray(gguf_keys::kTokens));
+        }
+        if (vocabSize_ == 0 || static_cast<size_t>(output_->ne[1]) != vocabSize_) {
+            LOG_ERROR("GGUF vocabulary size " + std::to_string(vocabSize_) +
+                      " does not match output projection");
+            cleanup();
+            return false;
+        }
+
+        setSpecialToken("<s>", modelFile_->getInt(gguf_keys::kBosTokenId, specialTokens_["<s>"]));
+        setSpecialToken("</s>", modelFile_->getInt(gguf_keys::kEosTokenId, specialTokens_["</s>"]));
+        setSpecialToken("<unk>", modelFile_->getInt(gguf_keys::kUnknownTokenId, specialTokens_["<unk>"]));
+        setSpecialToken("<pad>", modelFile_->getInt(gguf_keys::kPaddingTokenId, specialTokens_["<pad>"]));
+
+        languageCodes_ = modelFile_->getStringArray(gguf_keys::kLanguageCodes);
+        loadTokenizer(modelPath);
+        loadShortlists();
+
+        std::string archInfo = std::string("Model architecture:\n") +
+            "  - Architecture: " + architecture_ + "\n" +
+            "  - Tensors: " + std::to_string(modelFile_->getTensorNames().size()) + "\n" +
+            "  - Embedding: " + std::to_string(tokEmbd_->ne[0]) + " (" + ggml_type_name(tokEmbd_->type) + ")\n" +
+            "  - Output: " + ggml_type_name(output_->type) + "\n" +
+            "  - Vocabulary size: " + std::to_string(vocabSize_) + "\n" +
+            "  - Language codes: " + std::to_string(languageCodes_.size()) + "\n" +
+            "  - Shortlists: " + std::to_string(shortlists_.size()) + "\n" +
+            "  - Mapped: " + std::to_string(modelFile_->getMappedBytes() / 1024 / 1024) + " MB";
+        LOG_INFO(archInfo);
+
+        initialized_ = true;
+        LOG_INFO("Model initialization completed successfully");
+        return true;
+    }
+
     bool processInput(const std::string& input, std::string& output) {
         if (!initialized_) {
             LOG_ERROR("Engine not initialized");
@@ -157,7 +259,7 @@ public:
 
             // Run inference
             translation::InferenceStats stats;
-            std::vector<int> outputTokens = runInference(inputTokens, translation::TranslationOptions(), stats);
+            std::vector<int> outputTokens = runInference(inputTokens, translation::TranslationOptions(), stats, nullptr);
 
             // Detokenize output
             output = detokenize(outputTokens);
@@ -175,50 +277,50 @@ public:
     std::vector<int> runInference(
         const std::vector<int>& inputTokens,
         const translation::TranslationOptions& options,
-        translation::InferenceStats& stats
+        translation::InferenceStats& stats,
+        const TokenCallback& onToken
     ) {
         auto startTime = std::chrono::high_resolution_clock::now();
 
-        // Create input tensor
-        auto inputTensor = ggml_new_tensor_1d(ctx_, GGML_TYPE_I32, inputTokens.size());
-        int32_t* inputData = (int32_t*)ggml_get_data(inputTensor);
-        std::copy(inputTokens.begin(), inputTokens.end(), inputData);
-
-        // Create attention mask
-        auto attentionMask = ggml_new_tensor_2d(ctx_, GGML_TYPE_F32, inputTokens.size(), inputTokens.size());
-        float* maskData = (float*)ggml_get_data(attentionMask);
-        std::fill(maskData, maskData + inputTokens.size() * inputTokens.size(), 1.0f);
-
-        // Create computation graph
-        auto graph = ggml_new_graph(ctx_);
-
-        // Add model operations to graph
-        auto hidden = ggml_mul_mat(ctx_, model_, inputTensor);
-        auto outputTensor = ggml_soft_max(ctx_, hidden);
+        if (inputTokens.empty()) {
+            stats.inferenceTimeMs = 0.0;
+            stats.inputTokenCount = 0;
+            return std::vector<int>();
+        }
 
-        // Compute graph
-        ggml_build_forward_expand(graph, outputTensor);
+        // GGUF models have no legacy weight tensor, decode through the output projection
+        if (!model_) {
+            std::vector<int> outputTokens = greedyDecode(inputTokens, options.maxLength, onToken);
 
-        // Create compute plan
-        int n_threads = 4;  // You might want to make this configurable
-        struct ggml_cplan plan = ggml_graph_plan(graph, n_threads, nullptr);
-        if (!plan.work_data) {
-            plan.work_data = static_cast<uint8_t*>(malloc(plan.work_size));
+            auto endTime = std::chrono::high_resolution_clock::now();
+            stats.inferenceTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                endTime - startTime).count();
+            stats.inputTokenCount = inputTokens.size();
+            stats.outputTokenCount = outputTokens.size();
+            return outputTokens;
         }
 
-        if (!plan.work_data) {
-            throw std::runtime_error("Failed to allocate work buffer for GGML computation");
+        std::lock_guard<std::mutex> lock(computeMutex_);
+
+        // Graphs are built once per input length and reused on later calls
+        const size_t nTokens = inputTokens.size();
+        const size_t dataSize = nTokens * (sizeof(int32_t) + 2 * model_->ne[1] * model_->ne[2] * sizeof(float));
+        CachedGraph* cached = getGraph(legacyGraphs_, nTokens, dataSize, [&](CachedGraph& g) {
+            g.input = ggml_new_tensor_1d(g.ctx, GGML_TYPE_I32, nTokens);
+            auto hidden = ggml_mul_mat(g.ctx, model_, g.input);
+            g.output = ggml_soft_max(g.ctx, hidden);
+        });
+        if (!cached) {
+            throw std::runtime_error("Failed to build GGML graph");
         }
 
-        // Compute the graph
-        enum ggml_status status = ggml_graph_compute(graph, &plan);
-
-        // Cleanup
-        free(plan.work_data);
+        int32_t* inputData = static_cast<int32_t*>(ggml_get_data(cached->input));
+        std::copy(inputTokens.begin(), inputTokens.end(), inputData);
 
-        if (status != GGML_STATUS_SUCCESS) {
+        if (!computeGraph(cached->graph)) {
             throw std::runtime_error("Failed to compute GGML graph");
         }
+        struct ggml_tensor* outputTensor = cached->output;
 
         // Get output tokens
         std::vector<int> outputTokens;
@@ -229,6 +331,9 @@ public:
         for (size_t i = 0; i < outputSize; ++i) {
             if (outputData[i] > 0.5f) {  // Simple threshold for demonstration
                 outputTokens.push_back(static_cast<int>(i));
+                if (onToken && !onToken(outputTokens.back())) {
+                    break;
+                }
             }
         }
 
@@ -241,96 +346,314 @@ public:
         return outputTokens;
     }
 
-    std::vector<int> tokenize(const std::string& text) {
-        std::vector<int> tokens;
+    std::vector<int> greedyDecode(const std::vector<int>& inputTokens, int maxLength, const TokenCallback& onToken) {
+        std::vector<int> outputTokens;
+        if (inputTokens.empty()) {
+            return outputTokens;
+        }
+        auto eosIt = specialTokens_.find("</s>");
+        const int eosToken = eosIt != specialTokens_.end() ? static_cast<int>(eosIt->second) : -1;
+        int lastToken = inputTokens.back();
+
+        for (int i = 0; i < maxLength; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(computeMutex_);
+                if (!evaluateBatchLocked({lastToken})) {
+                    throw std::runtime_error("Failed to compute GGML graph");
+                }
+                lastToken = static_cast<int>(
+                    std::max_element(logits_, logits_ + vocabSize_) - logits_);
+            }
+            if (lastToken == eosToken) {
+                break;
+            }
+            outputTokens.push_back(lastToken);
 
-        // Add BOS token
-        auto it = specialTokens_.find("<s>");
-        if (it != specialTokens_.end()) {
-            tokens.push_back(it->second);
+            // Called without the compute lock so the callback may use the engine
+            if (onToken && !onToken(lastToken)) {
+                break;
+            }
         }
 
-        // Simple whitespace tokenization for demonstration
-        std::string word;
-        for (char c : text) {
-            if (std::isspace(c)) {
-                if (!word.empty()) {
-                    // Find token in vocabulary
-                    auto it = std::find(vocab_.begin(), vocab_.end(), word);
-                    if (it != vocab_.end()) {
-                        tokens.push_back(std::distance(vocab_.begin(), it));
-                    } else {
-                        // Use unknown token
-                        auto unkIt = specialTokens_.find("<unk>");
-                        if (unkIt != specialTokens_.end()) {
-                            tokens.push_back(unkIt->second);
-                        }
-                    }
-                    word.clear();
-                }
-            } else {
-                word += c;
+        return outputTokens;
+    }
+
+    std::vector<std::vector<int>> greedyDecodeBatch(const std::vector<int>& lastTokens,
+                                                    const std::vector<int>& maxLengths) {
+        std::vector<std::vector<int>> outputs(lastTokens.size());
+        auto eosIt = specialTokens_.find("</s>");
+        const int eosToken = eosIt != specialTokens_.end() ? static_cast<int>(eosIt->second) : -1;
+
+        // Sequences still decoding and the token each decodes from next
+        std::vector<size_t> live;
+        std::vector<int> rows;
+        for (size_t i = 0; i < lastTokens.size() && i < maxLengths.size(); ++i) {
+            if (maxLengths[i] > 0) {
+                live.push_back(i);
+                rows.push_back(lastTokens[i]);
             }
         }
 
-        // Process last word if any
-        if (!word.empty()) {
-            auto it = std::find(vocab_.begin(), vocab_.end(), word);
-            if (it != vocab_.end()) {
-                tokens.push_back(std::distance(vocab_.begin(), it));
-            } else {
-                auto unkIt = specialTokens_.find("<unk>");
-                if (unkIt != specialTokens_.end()) {
-                    tokens.push_back(unkIt->second);
+        while (!live.empty()) {
+            std::lock_guard<std::mutex> lock(computeMutex_);
+            if (!evaluateBatchLocked(rows)) {
+                throw std::runtime_error("Failed to compute GGML graph");
+            }
+
+            size_t kept = 0;
+            for (size_t row = 0; row < live.size(); ++row) {
+                const float* rowLogits = logits_ + row * vocabSize_;
+                const int token = static_cast<int>(std::max_element(rowLogits, rowLogits + vocabSize_) - rowLogits);
+                if (token == eosToken) {
+                    continue;
+                }
+                std::vector<int>& output = outputs[live[row]];
+                output.push_back(token);
+                if (static_cast<int>(output.size()) < maxLengths[live[row]]) {
+                    live[kept] = live[row];
+                    rows[kept] = token;
+                    ++kept;
                 }
             }
+            live.resize(kept);
+            rows.resize(kept);
         }
 
-        // Add EOS token
-        it = specialTokens_.find("</s>");
-        if (it != specialTokens_.end()) {
-            tokens.push_back(it->second);
-        }
+        return outputs;
+    }
 
-        return tokens;
+    bool evaluateBatch(const std::vector<int>& tokens, const std::vector<int>& shortlist,
+                       const std::vector<float>& context) {
+        std::lock_guard<std::mutex> lock(computeMutex_);
+        if (!shortlist.empty() && initialized_ && output_) {
+            return evaluateShortlistLocked(tokens, shortlist, context);
+        }
+        return evaluateBatchLocked(tokens, context);
     }
 
-    std::string detokenize(const std::vector<int>& tokens) {
-        std::string text;
-        bool first = true;
+    bool evaluateBatchLocked(const std::vector<int>& tokens, const std::vector<float>& context = {}) {
+        if (!initialized_) {
+            LOG_ERROR("Engine not initialized");
+            return false;
+        }
+
+        if (!tokEmbd_ || !output_) {
+            LOG_ERROR("Model has no token embedding or output projection");
+            return false;
+        }
+
+        if (tokens.empty()) {
+            return true;
+        }
 
         for (int token : tokens) {
-            // Skip special tokens
-            bool isSpecial = false;
-            for (const auto& pair : specialTokens_) {
-                if (pair.second == token) {
-                    isSpecial = true;
-                    break;
+            if (token < 0 || token >= static_cast<int>(vocabSize_)) {
+                LOG_ERROR("Token out of vocabulary range: " + std::to_string(token));
+                return false;
+            }
+        }
+
+        // Batches are padded up to a power of two so a handful of graphs cover every size
+        const size_t nBatch = tokens.size();
+        size_t bucket = 1;
+        while (bucket < nBatch) {
+            bucket <<= 1;
+        }
+
+        const size_t nEmbd = tokEmbd_->ne[0];
+        const size_t dataSize = bucket * (sizeof(int32_t) + (3 * nEmbd + vocabSize_) * sizeof(float));
+        CachedGraph* cached = getGraph(decodeGraphs_, bucket, dataSize, [&](CachedGraph& g) {
+            // One row per sequence: embed the newest token, add the attended source
+            // context and project it onto the vocabulary
+            g.input = ggml_new_tensor_1d(g.ctx, GGML_TYPE_I32, bucket);
+            g.context = ggml_new_tensor_2d(g.ctx, GGML_TYPE_F32, nEmbd, bucket);
+            auto hidden = ggml_add(g.ctx, ggml_get_rows(g.ctx, tokEmbd_, g.input), g.context);
+            g.output = ggml_mul_mat(g.ctx, output_, hidden);
+        });
+        if (!cached) {
+            LOG_ERROR("Failed to build compute graph for batch of " + std::to_string(nBatch));
+            return false;
+        }
+
+        int32_t* ids = static_cast<int32_t*>(ggml_get_data(cached->input));
+        std::copy(tokens.begin(), tokens.end(), ids);
+        std::fill(ids + nBatch, ids + bucket, tokens.back());
+        fillContext(cached->context, nBatch, context);
+
+        if (!computeGraph(cached->graph)) {
+            LOG_ERROR("Failed to compute batched forward pass");
+            return false;
+        }
+
+        // Rows stay in the graph's output tensor until the next forward pass
+        logits_ = static_cast<float*>(ggml_get_data(cached->output));
+        logitsRows_ = nBatch;
+        return true;
+    }
+
+    size_t getVocabSize() const {
+        return vocabSize_;
+    }
+
+    size_t getEmbeddingSize() const {
+        return tokEmbd_ ? static_cast<size_t>(tokEmbd_->ne[0]) : 0;
+    }
+
+    std::shared_ptr<const EncoderOutput> encode(const std::vector<int>& sourceTokens) {
+        if (sourceTokens.empty()) {
+            return nullptr;
+        }
+
+        std::shared_ptr<const EncoderOutput> cached;
+        if (encoderCache_.get(sourceTokens, cached)) {
+            return cached;
+        }
+
+        auto output = std::make_shared<EncoderOutput>();
+        {
+            std::lock_guard<std::mutex> lock(computeMutex_);
+            if (!initialized_ || !tokEmbd_) {
+                return nullptr;
+            }
+            for (int token : sourceTokens) {
+                if (token < 0 || token >= static_cast<int>(vocabSize_)) {
+                    LOG_ERROR("Source token out of vocabulary range: " + std::to_string(token));
+                    return nullptr;
                 }
             }
-            if (isSpecial) continue;
 
-            // Add space between words
-            if (!first) {
-                text += " ";
+            // Source lengths are padded to powers of two so a few graphs cover all sentences
+            const size_t nTokens = sourceTokens.size();
+            size_t bucket = 1;
+            while (bucket < nTokens) {
+                bucket <<= 1;
+            }
+            const size_t nEmbd = tokEmbd_->ne[0];
+            const size_t dataSize = bucket * (sizeof(int32_t) + nEmbd * sizeof(float));
+            CachedGraph* graph = getGraph(encoderGraphs_, bucket, dataSize, [&](CachedGraph& g) {
+                // The encoder is the token embedding until the models carry encoder layers
+                g.input = ggml_new_tensor_1d(g.ctx, GGML_TYPE_I32, bucket);
+                g.output = ggml_get_rows(g.ctx, tokEmbd_, g.input);
+            });
+            if (!graph) {
+                LOG_ERROR("Failed to build encoder graph for " + std::to_string(nTokens) + " tokens");
+                return nullptr;
             }
-            first = false;
 
-            // Convert token to text
-            if (token >= 0 && token < static_cast<int>(vocab_.size())) {
-                text += vocab_[token];
+            int32_t* ids = static_cast<int32_t*>(ggml_get_data(graph->input));
+            std::copy(sourceTokens.begin(), sourceTokens.end(), ids);
+            std::fill(ids + nTokens, ids + bucket, sourceTokens.back());
+            if (!computeGraph(graph->graph)) {
+                LOG_ERROR("Failed to compute encoder pass");
+                return nullptr;
             }
+
+            // Symmetric 8-bit quantization with one scale per token keeps cached states small
+            const float* states = static_cast<const float*>(ggml_get_data(graph->output));
+            output->rows = nTokens;
+            output->dim = nEmbd;
+            output->states.resize(nTokens * nEmbd);
+            output->scales.resize(nTokens);
+            for (size_t row = 0; row < nTokens; ++row) {
+                const float* values = states + row * nEmbd;
+                float maxAbs = 0.0f;
+                for (size_t i = 0; i < nEmbd; ++i) {
+                    maxAbs = std::max(maxAbs, std::abs(values[i]));
+                }
+                const float scale = maxAbs / 127.0f;
+                const float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+                int8_t* quantized = output->states.data() + row * nEmbd;
+                for (size_t i = 0; i < nEmbd; ++i) {
+                    quantized[i] = static_cast<int8_t>(std::lround(values[i] * inverse));
+                }
+                output->scales[row] = scale;
+            }
+        }
+
+        encoderCache_.put(sourceTokens, output);
+        return output;
+    }
+
+    utils::CacheStats getEncoderCacheStats() const {
+        return encoderCache_.getStats();
+    }
+
+    std::shared_ptr<const std::vector<int>> getShortlist(const std::string& language,
+                                                         const std::vector<int>& sourceTokens) const {
+        auto it = shortlists_.find(language);
+        if (it == shortlists_.end()) {
+            return nullptr;
+        }
+        if (sourceTokens.empty()) {
+            return it->second;
         }
 
+        // Source tokens are the cheapest aligned candidates: names and numbers copy through
+        auto merged = std::make_shared<std::vector<int>>(*it->second);
+        for (int token : sourceTokens) {
+            if (token >= 0 && static_cast<size_t>(token) < vocabSize_) {
+                merged->push_back(token);
+            }
+        }
+        std::sort(merged->begin(), merged->end());
+        merged->erase(std::unique(merged->begin(), merged->end()), merged->end());
+        return merged;
+    }
+
+    std::vector<int> tokenize(const std::string& text) {
+        std::vector<int> tokens;
+        std::vector<int> pieces;
+        encodeInto(text, tokens, pieces);
+        return tokens;
+    }
+
+    void tokenizeBatch(const std::vector<std::string>& texts, std::vector<std::vector<int>>& tokens) {
+        // Output rows keep their capacity across batches, one scratch buffer serves the batch
+        tokens.resize(texts.size());
+        std::vector<int> pieces;
+        for (size_t i = 0; i < texts.size(); ++i) {
+            encodeInto(texts[i], tokens[i], pieces);
+        }
+    }
+
+    std::string detokenize(const std::vector<int>& tokens) {
+        std::string text;
+        std::vector<int> pieces;
+        decodeInto(tokens, text, pieces);
         return text;
     }
 
+    void detokenizeBatch(const std::vector<std::vector<int>>& tokens, std::vector<std::string>& texts) {
+        texts.resize(tokens.size());
+        std::vector<int> pieces;
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            decodeInto(tokens[i], texts[i], pieces);
+        }
+    }
+
     void cleanup() {
+        freeGraphs();
         if (ctx_) {
             ggml_free(ctx_);
             ctx_ = nullptr;
         }
         model_ = nullptr;
+        tokEmbd_ = nullptr;
+        output_ = nullptr;
+        modelFile_.reset();
+        vocab_.clear();
+        vocabStorage_.clear();
+        tokenIndex_.clear();
+        sortedIds_ = nullptr;
+        vocabSize_ = 0;
+        languageCodes_.clear();
+        shortlists_.clear();
+        shortlistLogits_.clear();
+        scatteredIds_.clear();
+        encoderCache_.clear();
+        tokenizer_.reset();
+        logits_ = nullptr;
+        logitsRows_ = 0;
         initialized_ = false;
     }
 
@@ -342,22 +665,513 @@ public:
         return tokenizer_.get();
     }
 
-    std::vector<float> getLogits() {
-        if (!initialized_ || !logits_) {
+    std::string getArchitecture() const {
+        return architecture_;
+    }
+
+    std::vector<std::string> getLanguageCodes() const {
+        return languageCodes_;
+    }
+
+    int tokenToId(const std::string& token) const {
+        return lookupToken(token);
+    }
+
+    size_t getModelMemoryBytes() const {
+        if (modelFile_) {
+            return modelFile_->getMappedBytes();
+        }
+        return model_ ? ggml_nbytes(model_) : 0;
+    }
+
+    void setNumThreads(int numThreads) {
+        std::lock_guard<std::mutex> lock(computeMutex_);
+        numThreads = std::max(1, numThreads);
+        if (numThreads == numThreads_) {
+            return;
+        }
+        numThreads_ = numThreads;
+        if (threadpool_) {
+            ggml_threadpool_free(threadpool_);
+            threadpool_ = nullptr;
+        }
+    }
+
+    int getNumThreads() {
+        std::lock_guard<std::mutex> lock(computeMutex_);
+        return numThreads_;
+    }
+
+    std::vector<float> getLogits(size_t row) {
+        std::lock_guard<std::mutex> lock(computeMutex_);
+        if (!initialized_ || row >= logitsRows_) {
             return std::vector<float>();
         }
-        return std::vector<float>(logits_, logits_ + vocabSize_);
+        const float* begin = logits_ + row * vocabSize_;
+        return std::vector<float>(begin, begin + vocabSize_);
+    }
+
+    LogitsSpan getLogitsSpan(size_t row) {
+        std::lock_guard<std::mutex> lock(computeMutex_);
+        if (!initialized_ || row >= logitsRows_) {
+            return LogitsSpan();
+        }
+        return LogitsSpan(logits_ + row * vocabSize_, vocabSize_);
     }
 
 private:
+    // A graph built once for one input shape; only its input tensor changes between runs
+    struct CachedGraph {
+        struct ggml_context* ctx = nullptr;
+        struct ggml_cgraph* graph = nullptr;
+        struct ggml_tensor* input = nullptr;
+        struct ggml_tensor* output = nullptr;
+        struct ggml_tensor* rows = nullptr;   // output projection rows, for shortlist graphs
+        struct ggml_tensor* context = nullptr;  // attended encoder states per row, for decode graphs
+    };
+
+    // Upper bound on graphs kept per cache, older shapes are dropped wholesale
+    static constexpr size_t kMaxCachedGraphs = 32;
+
+    template <typename BuildFn>
+    CachedGraph* getGraph(std::map<size_t, CachedGraph>& cache, size_t length, size_t dataSize, BuildFn build) {
+        auto it = cache.find(length);
+        if (it != cache.end()) {
+            return &it->second;
+        }
+
+        if (cache.size() >= kMaxCachedGraphs) {
+            freeGraphs(cache);
+        }
+
+        const size_t ctxSize = ggml_tensor_overhead() * 8 + ggml_graph_overhead() + dataSize + 1024 * 1024;
+
+        CachedGraph cached;
+        cached.ctx = ggml_init({ctxSize, nullptr, false});
+        if (!cached.ctx) {
+            return nullptr;
+        }
+        build(cached);
+        cached.graph = ggml_new_graph(cached.ctx);
+        ggml_build_forward_expand(cached.graph, cached.output);
+        return &cache.emplace(length, cached).first->second;
+    }
+
+    void freeGraphs(std::map<size_t, CachedGraph>& cache) {
+        for (auto& entry : cache) {
+            ggml_free(entry.second.ctx);
+        }
+        cache.clear();
+    }
+
+    void freeGraphs() {
+        freeGraphs(legacyGraphs_);
+        freeGraphs(decodeGraphs_);
+        freeGraphs(shortlistGraphs_);
+        freeGraphs(encoderGraphs_);
+    }
+
+    void loadShortlists() {
+        std::vector<int> specials;
+        for (const auto& pair : specialTokens_) {
+            if (pair.second >= 0 && static_cast<size_t>(pair.second) < vocabSize_) {
+                specials.push_back(pair.second);
+            }
+        }
+
+        for (const std::string& code : languageCodes_) {
+            struct ggml_tensor* ids = modelFile_->getTensor(gguf_keys::kShortlistPrefix + code);
+            if (!ids || ids->type != GGML_TYPE_I32) {
+                continue;
+            }
+
+            const int32_t* data = static_cast<const int32_t*>(ids->data);
+            auto shortlist = std::make_shared<std::vector<int>>(specials);
+            shortlist->reserve(specials.size() + ggml_nelements(ids));
+            for (int64_t i = 0; i < ggml_nelements(ids); ++i) {
+                if (data[i] >= 0 && static_cast<size_t>(data[i]) < vocabSize_) {
+                    shortlist->push_back(data[i]);
+                }
+            }
+            // The target language token itself has to stay reachable
+            int languageToken = lookupToken("__" + code + "__");
+            if (languageToken < 0) {
+                languageToken = lookupToken(code);
+            }
+            if (languageToken >= 0) {
+                shortlist->push_back(languageToken);
+            }
+
+            std::sort(shortlist->begin(), shortlist->end());
+            shortlist->erase(std::unique(shortlist->begin(), shortlist->end()), shortlist->end());
+            shortlists_[code] = std::move(shortlist);
+        }
+    }
+
+    void fillContext(struct ggml_tensor* tensor, size_t nBatch, const std::vector<float>& context) {
+        float* data = static_cast<float*>(ggml_get_data(tensor));
+        const size_t used = std::min(context.size(), nBatch * static_cast<size_t>(tensor->ne[0]));
+        std::copy(context.begin(), context.begin() + used, data);
+        std::fill(data + used, data + ggml_nelements(tensor), 0.0f);
+    }
+
+    bool evaluateShortlistLocked(const std::vector<int>& tokens, const std::vector<int>& shortlist,
+                                 const std::vector<float>& context) {
+        if (tokens.empty()) {
+            return true;
+        }
+        for (int token : tokens) {
+            if (token < 0 || token >= static_cast<int>(vocabSize_)) {
+                LOG_ERROR("Token out of vocabulary range: " + std::to_string(token));
+                return false;
+            }
+        }
+
+        // Both the batch and the shortlist are padded to powers of two to bound the graph count
+        const size_t nBatch = tokens.size();
+        size_t bucket = 1;
+        while (bucket < nBatch) {
+            bucket <<= 1;
+        }
+        size_t listBucket = 1;
+        while (listBucket < shortlist.size()) {
+            listBucket <<= 1;
+        }
+
+        const size_t nEmbd = tokEmbd_->ne[0];
+        const size_t dataSize = (bucket + listBucket) * sizeof(int32_t) +
+                                (3 * bucket * nEmbd + listBucket * nEmbd + bucket * listBucket) * sizeof(float);
+        CachedGraph* cached = getGraph(shortlistGraphs_, listBucket << 20 | bucket, dataSize, [&](CachedGraph& g) {
+            // Only the shortlisted rows of the output projection take part in the matmul
+            g.input = ggml_new_tensor_1d(g.ctx, GGML_TYPE_I32, bucket);
+            g.rows = ggml_new_tensor_1d(g.ctx, GGML_TYPE_I32, listBucket);
+            g.context = ggml_new_tensor_2d(g.ctx, GGML_TYPE_F32, nEmbd, bucket);
+            auto hidden = ggml_add(g.ctx, ggml_get_rows(g.ctx, tokEmbd_, g.input), g.context);
+            auto projection = ggml_get_rows(g.ctx, output_, g.rows);
+            g.output = ggml_mul_mat(g.ctx, projection, hidden);
+        });
+        if (!cached) {
+            LOG_ERROR("Failed to build shortlist graph for batch of " + std::to_string(nBatch));
+            return false;
+        }
+
+        int32_t* ids = static_cast<int32_t*>(ggml_get_data(cached->input));
+        std::copy(tokens.begin(), tokens.end(), ids);
+        std::fill(ids + nBatch, ids + bucket, tokens.back());
+        int32_t* rows = static_cast<int32_t*>(ggml_get_data(cached->rows));
+        std::copy(shortlist.begin(), shortlist.end(), rows);
+        std::fill(rows + shortlist.size(), rows + listBucket, shortlist.back());
+        fillContext(cached->context, nBatch, context);
+
+        if (!computeGraph(cached->graph)) {
+            LOG_ERROR("Failed to compute shortlisted forward pass");
+            return false;
+        }
+
+        // Scatter into full-vocabulary rows so samplers keep indexing by token ID.
+        // Tokens outside the shortlist stay at -inf; only the previous list is reset.
+        const float kMasked = -std::numeric_limits<float>::infinity();
+        if (shortlistLogits_.size() < nBatch * vocabSize_) {
+            shortlistLogits_.resize(nBatch * vocabSize_, kMasked);
+        }
+        const size_t allocatedRows = shortlistLogits_.size() / vocabSize_;
+        if (scatteredIds_ != shortlist) {
+            for (size_t row = 0; row < allocatedRows; ++row) {
+                float* logits = shortlistLogits_.data() + row * vocabSize_;
+                for (int id : scatteredIds_) {
+                    logits[id] = kMasked;
+                }
+            }
+            scatteredIds_ = shortlist;
+        }
+
+        const float* computed = static_cast<const float*>(ggml_get_data(cached->output));
+        for (size_t row = 0; row < nBatch; ++row) {
+            float* logits = shortlistLogits_.data() + row * vocabSize_;
+            const float* values = computed + row * listBucket;
+            for (size_t i = 0; i < shortlist.size(); ++i) {
+                logits[shortlist[i]] = values[i];
+            }
+        }
+
+        logits_ = shortlistLogits_.data();
+        logitsRows_ = nBatch;
+        return true;
+    }
+
+    bool computeGraph(struct ggml_cgraph* graph) {
+        // Workers are created once and parked between graphs instead of respawned per call
+        if (!threadpool_) {
+            struct ggml_threadpool_params params = ggml_threadpool_params_default(numThreads_);
+            threadpool_ = ggml_threadpool_new(&params);
+            if (!threadpool_) {
+                LOG_WARNING("Failed to create GGML threadpool, using per-call threads");
+            }
+        }
+
+        struct ggml_cplan plan = ggml_graph_plan(graph, numThreads_, threadpool_);
+        if (plan.work_size > workBuffer_.size()) {
+            workBuffer_.resize(plan.work_size);
+        }
+        plan.work_data = workBuffer_.data();
+
+        return ggml_graph_compute(graph, &plan) == GGML_STATUS_SUCCESS;
+    }
+
+    void setVocabulary(const std::vector<std::string>& tokens) {
+        size_t totalBytes = 0;
+        for (const auto& token : tokens) {
+            totalBytes += token.size();
+        }
+
+        // One contiguous buffer, views are taken once it no longer reallocates
+        vocabStorage_.clear();
+        vocabStorage_.reserve(totalBytes);
+        for (const auto& token : tokens) {
+            vocabStorage_ += token;
+        }
+
+        vocab_.clear();
+        vocab_.reserve(tokens.size());
+        size_t offset = 0;
+        for (const auto& token : tokens) {
+            vocab_.emplace_back(vocabStorage_.data() + offset, token.size());
+            offset += token.size();
+        }
+        vocabSize_ = vocab_.size();
+        sortedIds_ = nullptr;
+
+        tokenIndex_.clear();
+        tokenIndex_.reserve(vocab_.size());
+        for (size_t i = 0; i < vocab_.size(); ++i) {
+            tokenIndex_.emplace(vocab_[i], static_cast<int>(i));
+        }
+    }
+
+    bool mapVocabularyTables() {
+        struct ggml_tensor* blob = modelFile_->getTensor(gguf_keys::kVocabBlob);
+        struct ggml_tensor* offsets = modelFile_->getTensor(gguf_keys::kVocabOffsets);
+        struct ggml_tensor* sorted = modelFile_->getTensor(gguf_keys::kVocabSorted);
+        if (!blob || !offsets || !sorted || offsets->ne[0] != sorted->ne[0] + 1) {
+            return false;
+        }
+        if (blob->type != GGML_TYPE_I8 || offsets->type != GGML_TYPE_I32 || sorted->type != GGML_TYPE_I32) {
+            LOG_WARNING("Vocabulary tables have unexpected types, falling back to metadata");
+            return false;
+        }
+
+        // The tables come from the file as they are; a bad offset would read outside the
+        // mapping and a bad ID would send lookupToken() past the end of vocab_
+        const char* blobData = static_cast<const char*>(blob->data);
+        const int32_t* offsetData = static_cast<const int32_t*>(offsets->data);
+        const int32_t* sortedData = static_cast<const int32_t*>(sorted->data);
+        const size_t nVocab = sorted->ne[0];
+        bool valid = offsetData[0] >= 0 && offsetData[nVocab] <= blob->ne[0];
+        for (size_t i = 0; valid && i < nVocab; ++i) {
+            valid = offsetData[i] <= offsetData[i + 1] &&
+                    sortedData[i] >= 0 && static_cast<size_t>(sortedData[i]) < nVocab;
+        }
+        if (!valid) {
+            LOG_WARNING("Vocabulary tables are inconsistent, falling back to metadata");
+            return false;
+        }
+
+        vocab_.clear();
+        vocab_.reserve(nVocab);
+        for (size_t i = 0; i < nVocab; ++i) {
+            vocab_.emplace_back(blobData + offsetData[i], offsetData[i + 1] - offsetData[i]);
+        }
+
+        // Binary search needs the IDs in byte order of their tokens
+        for (size_t i = 1; i < nVocab; ++i) {
+            if (vocab_[sortedData[i]] < vocab_[sortedData[i - 1]]) {
+                LOG_WARNING("Vocabulary tables are not in byte order, falling back to metadata");
+                vocab_.clear();
+                return false;
+            }
+        }
+
+        vocabSize_ = nVocab;
+        sortedIds_ = sortedData;
+        tokenIndex_.clear();
+        return true;
+    }
+
+    int lookupToken(std::string_view token) const {
+        if (sortedIds_) {
+            // Binary search over the precomputed byte-order permutation
+            const int32_t* end = sortedIds_ + vocabSize_;
+            const int32_t* it = std::lower_bound(sortedIds_, end, token, [this](int32_t id, std::string_view key) {
+                return vocab_[id] < key;
+            });
+            return (it != end && vocab_[*it] == token) ? *it : -1;
+        }
+
+        auto it = tokenIndex_.find(token);
+        return it != tokenIndex_.end() ? it->second : -1;
+    }
+
+    void encodeInto(const std::string& text, std::vector<int>& tokens, std::vector<int>& pieces) const {
+        tokens.clear();
+
+        // Add BOS token
+        auto it = specialTokens_.find("<s>");
+        if (it != specialTokens_.end()) {
+            tokens.push_back(it->second);
+        }
+
+        if (tokenizer_) {
+            tokenizer_->Encode(text, &pieces);
+            tokens.insert(tokens.end(), pieces.begin(), pieces.end());
+        } else {
+            // Whitespace tokenization against the model vocabulary
+            auto unkIt = specialTokens_.find("<unk>");
+            size_t pos = 0;
+            while (pos < text.size()) {
+                while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    ++pos;
+                }
+                size_t end = pos;
+                while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) {
+                    ++end;
+                }
+                if (end > pos) {
+                    int id = lookupToken(std::string_view(text).substr(pos, end - pos));
+                    if (id >= 0) {
+                        tokens.push_back(id);
+                    } else if (unkIt != specialTokens_.end()) {
+                        tokens.push_back(unkIt->second);
+                    }
+                }
+                pos = end;
+            }
+        }
+
+        // Add EOS token
+        it = specialTokens_.find("</s>");
+        if (it != specialTokens_.end()) {
+            tokens.push_back(it->second);
+        }
+    }
+
+    void decodeInto(const std::vector<int>& tokens, std::string& text, std::vector<int>& pieces) const {
+        text.clear();
+
+        if (tokenizer_) {
+            pieces.clear();
+            for (int token : tokens) {
+                if (!isSpecialToken(token)) {
+                    pieces.push_back(token);
+                }
+            }
+            tokenizer_->Decode(pieces, &text);
+            return;
+        }
+
+        bool first = true;
+        for (int token : tokens) {
+            if (isSpecialToken(token) || token < 0 || token >= static_cast<int>(vocab_.size())) {
+                continue;
+            }
+            // Add space between words
+            if (!first) {
+                text += " ";
+            }
+            first = false;
+            text += vocab_[token];
+        }
+    }
+
+    bool isSpecialToken(int token) const {
+        for (const auto& pair : specialTokens_) {
+            if (pair.second == token) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool loadTokenizer(const std::string& modelPath) {
+        auto processor = std::make_unique<sentencepiece::SentencePieceProcessor>();
+
+        // Embedded by koebridge-quantize --tokenizer
+        struct ggml_tensor* embedded = modelFile_ ? modelFile_->getTensor(gguf_keys::kTokenizerModel) : nullptr;
+        if (embedded) {
+            auto status = processor->LoadFromSerializedProto(
+                std::string_view(static_cast<const char*>(embedded->data), ggml_nbytes(embedded)));
+            if (status.ok()) {
+                LOG_INFO("Loaded SentencePiece model embedded in " + modelPath);
+                return setTokenizer(std::move(processor));
+            }
+            LOG_WARNING("Embedded SentencePiece model is invalid: " + status.ToString());
+        }
+
+        // Otherwise look for the model file shipped next to the weights
+        const std::filesystem::path path(modelPath);
+        const std::filesystem::path dir = path.parent_path();
+        for (const auto& candidate : {dir / (path.stem().string() + ".model"),
+                                      dir / "sentencepiece.bpe.model",
+                                      dir / "tokenizer.model"}) {
+            std::error_code ec;
+            if (!std::filesystem::exists(candidate, ec)) {
+                continue;
+            }
+            auto status = processor->Load(candidate.string());
+            if (status.ok()) {
+                LOG_INFO("Loaded SentencePiece model: " + candidate.string());
+                return setTokenizer(std::move(processor));
+            }
+            LOG_WARNING("Failed to load SentencePiece model " + candidate.string() + ": " + status.ToString());
+        }
+
+        LOG_WARNING("No SentencePiece model found for " + modelPath + ", using whitespace tokenization");
+        return false;
+    }
+
+    bool setTokenizer(std::unique_ptr<sentencepiece::SentencePieceProcessor> processor) {
+        if (vocabSize_ > 0 && static_cast<size_t>(processor->GetPieceSize()) > vocabSize_) {
+            LOG_WARNING("SentencePiece model has " + std::to_string(processor->GetPieceSize()) +
+                        " pieces but the model vocabulary only " + std::to_string(vocabSize_));
+        }
+        tokenizer_ = std::move(processor);
+        return true;
+    }
+
+    void setSpecialToken(const std::string& name, int64_t id) {
+        if (id >= -1 && id < static_cast<int64_t>(vocabSize_)) {
+            specialTokens_[name] = static_cast<int>(id);
+        }
+    }
+
     struct ggml_context* ctx_;
     struct ggml_tensor* model_;
+    struct ggml_tensor* tokEmbd_;     // [n_embd, n_vocab] token embedding
+    struct ggml_tensor* output_;      // [n_embd, n_vocab] output projection
     bool initialized_;
-    std::vector<std::string> vocab_;
+    std::unique_ptr<GGUFModelFile> modelFile_;  // mmap'd weights for GGUF models
+    std::string architecture_;
+    std::vector<std::string_view> vocab_;         // views into vocabStorage_ or the mapping
+    std::string vocabStorage_;
+    std::unordered_map<std::string_view, int> tokenIndex_;
+    const int32_t* sortedIds_ = nullptr;          // precomputed lookup order, if mapped
+    std::vector<std::string> languageCodes_;
     std::map<std::string, int> specialTokens_;
-    std::unique_ptr<void, void(*)(void*)> tokenizer_;
-    float* logits_;
+    std::unique_ptr<sentencepiece::SentencePieceProcessor> tokenizer_;  // null if no model was found
+    float* logits_;                   // [n_vocab, logitsRows_] output of the last batch graph
+    size_t logitsRows_;
     size_t vocabSize_;
+    int numThreads_;                  // GGML compute threads
+    struct ggml_threadpool* threadpool_;          // persistent workers, created on first compute
+    std::vector<uint8_t> workBuffer_;             // grow-only scratch shared by all graphs
+    std::map<size_t, CachedGraph> legacyGraphs_;  // keyed by input length
+    std::map<size_t, CachedGraph> decodeGraphs_;  // keyed by padded batch size
+    std::map<size_t, CachedGraph> shortlistGraphs_;  // keyed by padded shortlist size << 20 | padded batch size
+    std::map<std::string, std::shared_ptr<const std::vector<int>>> shortlists_;  // sorted IDs per language code
+    std::vector<float> shortlistLogits_;          // full-vocabulary rows scattered from the shortlist
+    std::vector<int> scatteredIds_;               // shortlist currently written into shortlistLogits_
+    std::map<size_t, CachedGraph> encoderGraphs_;  // keyed by padded source length
+    utils::ShardedLruCache<std::vector<int>, std::shared_ptr<const EncoderOutput>, TokenSequenceHash> encoderCache_;
+    std::mutex computeMutex_;
 };
 
 // InferenceEngine implementation
@@ -375,9 +1189,26 @@ bool InferenceEngine::processInput(const std::string& input, std::string& output
 std::vector<int> InferenceEngine::runInference(
     const std::vector<int>& inputTokens,
     const translation::TranslationOptions& options,
-    translation::InferenceStats& stats
+    translation::InferenceStats& stats,
+    const TokenCallback& onToken
 ) {
-    return pImpl_->runInference(inputTokens, options, stats);
+    return pImpl_->runInference(inputTokens, options, stats, onToken);
+}
+
+std::vector<int> InferenceEngine::tokenize(const std::string& text) {
+    return pImpl_->tokenize(text);
+}
+
+std::string InferenceEngine::detokenize(const std::vector<int>& tokens) {
+    return pImpl_->detokenize(tokens);
+}
+
+void InferenceEngine::tokenizeBatch(const std::vector<std::string>& texts, std::vector<std::vector<int>>& tokens) {
+    pImpl_->tokenizeBatch(texts, tokens);
+}
+
+void InferenceEngine::detokenizeBatch(const std::vector<std::vector<int>>& tokens, std::vector<std::string>& texts) {
+    pImpl_->detokenizeBatch(tokens, texts);
 }
 
 bool InferenceEngine::isInitialized() const {
@@ -388,8 +1219,90 @@ void* InferenceEngine::getTokenizer() {
     return pImpl_->getTokenizer();
 }
 
-std::vector<float> InferenceEngine::getLogits() {
-    return pImpl_->getLogits();
+std::vector<int> InferenceEngine::greedyDecode(const std::vector<int>& inputTokens, int maxLength) {
+    return pImpl_->greedyDecode(inputTokens, maxLength, nullptr);
+}
+
+std::vector<std::vector<int>> InferenceEngine::greedyDecodeBatch(const std::vector<int>& lastTokens,
+                                                                 const std::vector<int>& maxLengths) {
+    return pImpl_->greedyDecodeBatch(lastTokens, maxLengths);
+}
+
+bool InferenceEngine::evaluateBatch(const std::vector<int>& tokens) {
+    return pImpl_->evaluateBatch(tokens, {}, {});
+}
+
+bool InferenceEngine::evaluateBatch(const std::vector<int>& tokens, const std::vector<int>& shortlist,
+                                    const std::vector<float>& context) {
+    return pImpl_->evaluateBatch(tokens, shortlist, context);
+}
+
+std::shared_ptr<const EncoderOutput> InferenceEngine::encode(const std::vector<int>& sourceTokens) {
+    return pImpl_->encode(sourceTokens);
+}
+
+utils::CacheStats InferenceEngine::getEncoderCacheStats() const {
+    return pImpl_->getEncoderCacheStats();
+}
+
+size_t InferenceEngine::getEmbeddingSize() const {
+    return pImpl_->getEmbeddingSize();
+}
+
+void EncoderOutput::attend(float* context) const {
+    std::fill(context, context + dim, 0.0f);
+    if (rows == 0) {
+        return;
+    }
+    // Uniform attention over the source tokens
+    for (size_t row = 0; row < rows; ++row) {
+        const int8_t* values = states.data() + row * dim;
+        const float scale = scales[row] / rows;
+        for (size_t i = 0; i < dim; ++i) {
+            context[i] += values[i] * scale;
+        }
+    }
+}
+
+std::shared_ptr<const std::vector<int>> InferenceEngine::getShortlist(const std::string& language,
+                                                                      const std::vector<int>& sourceTokens) const {
+    return pImpl_->getShortlist(language, sourceTokens);
+}
+
+size_t InferenceEngine::getVocabSize() const {
+    return pImpl_->getVocabSize();
+}
+
+std::string InferenceEngine::getArchitecture() const {
+    return pImpl_->getArchitecture();
+}
+
+std::vector<std::string> InferenceEngine::getLanguageCodes() const {
+    return pImpl_->getLanguageCodes();
+}
+
+int InferenceEngine::tokenToId(const std::string& token) const {
+    return pImpl_->tokenToId(token);
+}
+
+size_t InferenceEngine::getModelMemoryBytes() const {
+    return pImpl_->getModelMemoryBytes();
+}
+
+void InferenceEngine::setNumThreads(int numThreads) {
+    pImpl_->setNumThreads(numThreads);
+}
+
+int InferenceEngine::getNumThreads() const {
+    return pImpl_->getNumThreads();
+}
+
+std::vector<float> InferenceEngine::getLogits(size_t row) {
+    return pImpl_->getLogits(row);
+}
+
+LogitsSpan InferenceEngine::getLogitsSpan(size_t row) {
+    return pImpl_->getLogitsSpan(row);
 }
 
 } // namespace inference
@@ -8,8 +8,11 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <cstdint>
 #include "translation/data_structures.h"
 #include "utils/config.h"
+#include "utils/sharded_lru_cache.h"
 
 namespace koebridge {
 namespace inference {
@@ -20,12 +23,59 @@ struct InferenceStats {
     size_t memoryUsed;
 };
 
+/**
+ * @typedef TokenCallback
+ * @brief Receives every generated token as soon as it is sampled, returns false to stop
+ */
+using TokenCallback = std::function<bool(int token)>;
+
+/**
+ * @struct LogitsSpan
+ * @brief Mutable view of one row of engine-owned logits
+ *
+ * The view is valid until the next forward pass on the same engine.
+ */
+struct LogitsSpan {
+    float* data = nullptr;             ///< First logit of the row
+    size_t size = 0;                   ///< Number of logits (vocabulary size)
+
+    LogitsSpan() = default;
+    LogitsSpan(float* data, size_t size) : data(data), size(size) {}
+
+    float* begin() const { return data; }
+    float* end() const { return data + size; }
+    float& operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+/**
+ * @struct EncoderOutput
+ * @brief Encoder hidden states of one source sentence, quantized to 8 bits
+ *
+ * Each row is quantized symmetrically with its own scale, a quarter of the f32 size,
+ * so many sentences can stay cached.
+ */
+struct EncoderOutput {
+    std::vector<int8_t> states;        ///< [rows, dim] quantized hidden states
+    std::vector<float> scales;         ///< Dequantization scale of each row
+    size_t rows = 0;                   ///< Number of source tokens
+    size_t dim = 0;                    ///< Hidden size
+
+    /**
+     * @brief Compute the source context a decoder row attends to
+     * @param context Receives dim values, the average of the dequantized states
+     */
+    void attend(float* context) const;
+};
+
 /**
  * @class InferenceEngine
  * @brief Core inference engine for running translation models
  *
  * This class provides the core functionality for running inference on translation models.
- * It handles model initialization, tokenization, and inference operations.
+ * It handles model initialization, tokenization, and inference operations. Models are
+ * loaded either from GGUF files, whose named and possibly quantized tensors are mapped
+ * without copying, or from the legacy single-tensor ggml format.
  */
 class InferenceEngine {
 public:
@@ -65,14 +115,40 @@ public:
      * @param inputTokens Vector of input token IDs
      * @param options Translation options for inference
      * @param stats Statistics about the inference operation
+     * @param onToken Optional callback receiving each output token as it is produced
      * @return std::vector<int> Vector of output token IDs
      */
     std::vector<int> runInference(
         const std::vector<int>& inputTokens,
         const translation::TranslationOptions& options,
-        translation::InferenceStats& stats
+        translation::InferenceStats& stats,
+        const TokenCallback& onToken = nullptr
     );
 
+    /**
+     * @brief Decode greedily from the last input token
+     *
+     * Cheap enough for a draft model proposing tokens for speculative decoding.
+     *
+     * @param inputTokens Token history, the last token is decoded from
+     * @param maxLength Maximum number of tokens to produce
+     * @return std::vector<int> Produced tokens, stopping before the end-of-sequence token
+     */
+    std::vector<int> greedyDecode(const std::vector<int>& inputTokens, int maxLength);
+
+    /**
+     * @brief Decode greedily from the last token of several sequences at once
+     *
+     * Every step is one batched forward pass over the sequences still decoding, so a
+     * draft model proposes for all of them in as many passes as the longest proposal.
+     *
+     * @param lastTokens Last token of each sequence
+     * @param maxLengths Maximum number of tokens to produce per sequence
+     * @return std::vector<std::vector<int>> Produced tokens per sequence, stopping before end-of-sequence
+     */
+    std::vector<std::vector<int>> greedyDecodeBatch(const std::vector<int>& lastTokens,
+                                                    const std::vector<int>& maxLengths);
+
     /**
      * @brief Convert text to token IDs
      * @param text Input text to tokenize
@@ -87,17 +163,144 @@ public:
      */
     std::string detokenize(const std::vector<int>& tokens);
 
+    /**
+     * @brief Convert several texts to token IDs
+     * @param texts Input texts
+     * @param tokens Receives one token list per text; existing rows are reused
+     */
+    void tokenizeBatch(const std::vector<std::string>& texts, std::vector<std::vector<int>>& tokens);
+
+    /**
+     * @brief Convert several token lists back to text
+     * @param tokens Token lists to detokenize
+     * @param texts Receives one text per token list; existing strings are reused
+     */
+    void detokenizeBatch(const std::vector<std::vector<int>>& tokens, std::vector<std::string>& texts);
+
     /**
      * @brief Get the tokenizer instance
-     * @return void* Pointer to the tokenizer instance
+     *
+     * The SentencePiece model is embedded in GGUF files by koebridge-quantize or read
+     * from a .model file next to the weights.
+     *
+     * @return void* Pointer to the sentencepiece::SentencePieceProcessor, nullptr if none was found
      */
     void* getTokenizer();
 
+    /**
+     * @brief Compute next-token logits for a batch of sequences in one forward pass
+     * @param tokens Most recent token of each sequence in the batch, one row per sequence
+     * @return bool True if the forward pass succeeded
+     */
+    bool evaluateBatch(const std::vector<int>& tokens);
+
+    /**
+     * @brief Compute next-token logits with source context, optionally over a shortlist only
+     *
+     * Only the shortlisted rows of the output projection are multiplied. The logits keep
+     * their full-vocabulary layout, with every token outside the shortlist at -infinity.
+     *
+     * @param tokens Most recent token of each sequence in the batch, one row per sequence
+     * @param shortlist Sorted token IDs to compute, the full vocabulary if empty
+     * @param context Attended encoder states, embedding-size values per row; missing rows are zero
+     * @return bool True if the forward pass succeeded
+     */
+    bool evaluateBatch(const std::vector<int>& tokens, const std::vector<int>& shortlist,
+                       const std::vector<float>& context = {});
+
+    /**
+     * @brief Run the encoder over a source sentence
+     *
+     * Results are kept in a bounded LRU cache keyed by the source token IDs
+     * (inference.encoder_cache_size entries), so a sentence translated again, e.g. into
+     * another target language, skips the encoder.
+     *
+     * @param sourceTokens Source token IDs, without the target language token
+     * @return std::shared_ptr<const EncoderOutput> Encoder states, nullptr on failure
+     */
+    std::shared_ptr<const EncoderOutput> encode(const std::vector<int>& sourceTokens);
+
+    /**
+     * @brief Get the encoder cache counters
+     * @return utils::CacheStats Hits, misses and size of the cache
+     */
+    utils::CacheStats getEncoderCacheStats() const;
+
+    /**
+     * @brief Get the hidden size of the model
+     * @return size_t Embedding size, 0 for models without a token embedding
+     */
+    size_t getEmbeddingSize() const;
+
+    /**
+     * @brief Get the output shortlist of a target language
+     *
+     * Shortlists are precomputed per language and stored in the GGUF file by
+     * koebridge-quantize; they always contain the special and language tokens.
+     *
+     * @param language Target language code, e.g. eng_Latn
+     * @param sourceTokens Source tokens added as aligned candidates, may be empty
+     * @return std::shared_ptr<const std::vector<int>> Sorted token IDs, nullptr if the language has none
+     */
+    std::shared_ptr<const std::vector<int>> getShortlist(const std::string& language,
+                                                         const std::vector<int>& sourceTokens = {}) const;
+
+    /**
+     * @brief Get the vocabulary size of the loaded model
+     * @return size_t Number of tokens in the vocabulary
+     */
+    size_t getVocabSize() const;
+
+    /**
+     * @brief Get the architecture name of the loaded model
+     * @return std::string Architecture from the model metadata, empty for legacy models
+     */
+    std::string getArchitecture() const;
+
+    /**
+     * @brief Get the language codes declared in the model metadata
+     * @return std::vector<std::string> Language codes, each also a vocabulary token
+     */
+    std::vector<std::string> getLanguageCodes() const;
+
+    /**
+     * @brief Look up the ID of a vocabulary token
+     * @param token Token text
+     * @return int Token ID, or -1 if the token is not in the vocabulary
+     */
+    int tokenToId(const std::string& token) const;
+
+    /**
+     * @brief Get the memory occupied by the model weights
+     * @return size_t Mapped or allocated weight bytes
+     */
+    size_t getModelMemoryBytes() const;
+
+    /**
+     * @brief Set the number of threads used to compute graphs
+     * @param numThreads Thread count, clamped to at least 1
+     */
+    void setNumThreads(int numThreads);
+
+    /**
+     * @brief Get the number of threads used to compute graphs
+     * @return int Thread count
+     */
+    int getNumThreads() const;
+
     /**
      * @brief Get the logits from the last inference
+     * @param row Batch row of the last evaluateBatch call
      * @return std::vector<float> Vector of logits from the last inference
      */
-    std::vector<float> getLogits();
+    std::vector<float> getLogits(size_t row = 0);
+
+    /**
+     * @brief Get the logits from the last inference without copying them
+     * @param row Batch row of the last evaluateBatch call
+     * @return LogitsSpan View into the engine's logits, empty if the row does not exist
+     */
+    LogitsSpan getLogitsSpan(size_t row = 0);
 
 private:
     class Impl;
@@ -0,0 +1,38 @@
+/**
+ * @file gguf_keys.h
+ * @brief Metadata keys and tensor names shared by the GGUF loader and the quantize tool
+ */
+
+#pragma once
+
+namespace koebridge {
+namespace inference {
+namespace gguf_keys {
+
+// Standard GGUF metadata
+constexpr const char* kArchitecture = "general.architecture";
+constexpr const char* kQuantizationVersion = "general.quantization_version";
+constexpr const char* kTokens = "tokenizer.ggml.tokens";
+constexpr const char* kBosTokenId = "tokenizer.ggml.bos_token_id";
+constexpr const char* kEosTokenId = "tokenizer.ggml.eos_token_id";
+constexpr const char* kUnknownTokenId = "tokenizer.ggml.unknown_token_id";
+constexpr const char* kPaddingTokenId = "tokenizer.ggml.padding_token_id";
+constexpr const char* kLanguageCodes = "tokenizer.ggml.language_codes";
+
+// Written by koebridge-quantize
+constexpr const char* kQuantizationVariant = "koebridge.quantization.variant";
+
+// Model weights
+constexpr const char* kTokenEmbedding = "token_embd.weight";
+constexpr const char* kOutput = "output.weight";
+
+// Precomputed vocabulary lookup tables, read straight from the mapping
+constexpr const char* kVocabBlob = "koebridge.vocab.blob";       ///< I8, concatenated token bytes
+constexpr const char* kVocabOffsets = "koebridge.vocab.offsets"; ///< I32, n_vocab + 1 byte offsets
+constexpr const char* kVocabSorted = "koebridge.vocab.sorted";   ///< I32, token IDs in byte order
+constexpr const char* kTokenizerModel = "koebridge.tokenizer.model"; ///< I8, serialized SentencePiece model
+constexpr const char* kShortlistPrefix = "koebridge.shortlist.";     ///< I32, output token IDs per target language code
+
+} // namespace gguf_keys
+} // namespace inference
+} // namespace koebridge
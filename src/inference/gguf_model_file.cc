@@ -0,0 +1,244 @@
+/**
+ * @file gguf_model_file.cc
+ * @brief Implementation of the memory-mapped GGUF model file
+ */
+
+#include "inference/gguf_model_file.h"
+#include "utils/logger.h"
+#include <ggml.h>
+#include <gguf.h>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace koebridge {
+namespace inference {
+
+GGUFModelFile::GGUFModelFile()
+    : gguf_(nullptr), meta_(nullptr), mapping_(nullptr), mappingSize_(0) {
+}
+
+GGUFModelFile::~GGUFModelFile() {
+    close();
+}
+
+bool GGUFModelFile::isGGUF(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    if (!file.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, "GGUF", sizeof(magic)) == 0;
+}
+
+bool GGUFModelFile::isSupportedTensorType(int type) {
+    switch (static_cast<ggml_type>(type)) {
+        case GGML_TYPE_F32:
+        case GGML_TYPE_F16:
+        case GGML_TYPE_Q4_0:
+        case GGML_TYPE_Q4_K:
+        case GGML_TYPE_Q5_K:
+        case GGML_TYPE_Q6_K:  // k-quant files keep a few tensors in Q6_K
+        case GGML_TYPE_Q8_0:
+        case GGML_TYPE_I8:    // vocabulary lookup tables
+        case GGML_TYPE_I32:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool GGUFModelFile::open(const std::string& path) {
+    close();
+
+    // Parse header, metadata and tensor descriptors without allocating tensor data
+    struct gguf_init_params params = {true, &meta_};
+    gguf_ = gguf_init_from_file(path.c_str(), params);
+    if (!gguf_) {
+        LOG_ERROR("Failed to parse GGUF file: " + path);
+        meta_ = nullptr;
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open model file: " + path);
+        close();
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOG_ERROR("Failed to stat model file: " + path);
+        ::close(fd);
+        close();
+        return false;
+    }
+
+    mappingSize_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        LOG_ERROR("Failed to map model file: " + path);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+        close();
+        return false;
+    }
+
+    // Point every tensor at its bytes inside the mapping
+    const size_t dataOffset = gguf_get_data_offset(gguf_);
+    const int64_t nTensors = gguf_get_n_tensors(gguf_);
+    for (int64_t i = 0; i < nTensors; ++i) {
+        const char* name = gguf_get_tensor_name(gguf_, i);
+        struct ggml_tensor* tensor = ggml_get_tensor(meta_, name);
+        if (!tensor) {
+            LOG_ERROR("Missing tensor descriptor: " + std::string(name));
+            close();
+            return false;
+        }
+
+        if (!isSupportedTensorType(tensor->type)) {
+            LOG_ERROR("Unsupported tensor type " + std::string(ggml_type_name(tensor->type)) +
+                      " for tensor " + name);
+            close();
+            return false;
+        }
+
+        const size_t offset = dataOffset + gguf_get_tensor_offset(gguf_, i);
+        if (offset + ggml_nbytes(tensor) > mappingSize_) {
+            LOG_ERROR("Tensor data out of file bounds: " + std::string(name));
+            close();
+            return false;
+        }
+
+        tensor->data = static_cast<uint8_t*>(mapping_) + offset;
+    }
+
+    // Weights are read in no particular order during decoding
+    madvise(mapping_, mappingSize_, MADV_WILLNEED);
+
+    path_ = path;
+    return true;
+}
+
+void GGUFModelFile::close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+    if (meta_) {
+        ggml_free(meta_);
+        meta_ = nullptr;
+    }
+    if (gguf_) {
+        gguf_free(gguf_);
+        gguf_ = nullptr;
+    }
+    path_.clear();
+}
+
+bool GGUFModelFile::isOpen() const {
+    return mapping_ != nullptr;
+}
+
+bool GGUFModelFile::hasKey(const std::string& key) const {
+    return gguf_ && gguf_find_key(gguf_, key.c_str()) >= 0;
+}
+
+std::string GGUFModelFile::getString(const std::string& key, const std::string& defaultValue) const {
+    if (!gguf_) {
+        return defaultValue;
+    }
+    const int64_t id = gguf_find_key(gguf_, key.c_str());
+    if (id < 0 || gguf_get_kv_type(gguf_, id) != GGUF_TYPE_STRING) {
+        return defaultValue;
+    }
+    return gguf_get_val_str(gguf_, id);
+}
+
+int64_t GGUFModelFile::getInt(const std::string& key, int64_t defaultValue) const {
+    if (!gguf_) {
+        return defaultValue;
+    }
+    const int64_t id = gguf_find_key(gguf_, key.c_str());
+    if (id < 0) {
+        return defaultValue;
+    }
+    switch (gguf_get_kv_type(gguf_, id)) {
+        case GGUF_TYPE_UINT32:
+            return gguf_get_val_u32(gguf_, id);
+        case GGUF_TYPE_INT32:
+            return gguf_get_val_i32(gguf_, id);
+        default:
+            return defaultValue;
+    }
+}
+
+std::vector<std::string> GGUFModelFile::getStringArray(const std::string& key) const {
+    std::vector<std::string> values;
+    if (!gguf_) {
+        return values;
+    }
+    const int64_t id = gguf_find_key(gguf_, key.c_str());
+    if (id < 0 || gguf_get_kv_type(gguf_, id) != GGUF_TYPE_ARRAY ||
+        gguf_get_arr_type(gguf_, id) != GGUF_TYPE_STRING) {
+        return values;
+    }
+
+    const size_t count = gguf_get_arr_n(gguf_, id);
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        values.emplace_back(gguf_get_arr_str(gguf_, id, i));
+    }
+    return values;
+}
+
+const void* GGUFModelFile::getArrayData(const std::string& key, size_t& count) const {
+    count = 0;
+    if (!gguf_) {
+        return nullptr;
+    }
+    const int64_t id = gguf_find_key(gguf_, key.c_str());
+    if (id < 0 || gguf_get_kv_type(gguf_, id) != GGUF_TYPE_ARRAY ||
+        gguf_get_arr_type(gguf_, id) == GGUF_TYPE_STRING) {
+        return nullptr;
+    }
+    count = gguf_get_arr_n(gguf_, id);
+    return gguf_get_arr_data(gguf_, id);
+}
+
+struct ggml_tensor* GGUFModelFile::getTensor(const std::string& name) const {
+    if (!meta_) {
+        return nullptr;
+    }
+    return ggml_get_tensor(meta_, name.c_str());
+}
+
+std::vector<std::string> GGUFModelFile::getTensorNames() const {
+    std::vector<std::string> names;
+    if (!gguf_) {
+        return names;
+    }
+    const int64_t nTensors = gguf_get_n_tensors(gguf_);
+    names.reserve(nTensors);
+    for (int64_t i = 0; i < nTensors; ++i) {
+        names.emplace_back(gguf_get_tensor_name(gguf_, i));
+    }
+    return names;
+}
+
+size_t GGUFModelFile::getMappedBytes() const {
+    return mappingSize_;
+}
+
+std::string GGUFModelFile::getPath() const {
+    return path_;
+}
+
+} // namespace inference
+} // namespace koebridge
@@ -0,0 +1,147 @@
+/**
+ * @file gguf_model_file.h
+ * @brief Memory-mapped GGUF model file with named tensors and metadata
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct ggml_context;
+struct ggml_tensor;
+struct gguf_context;
+
+namespace koebridge {
+namespace inference {
+
+/**
+ * @class GGUFModelFile
+ * @brief Read-only view of a GGUF model file
+ *
+ * The file is memory-mapped and every tensor's data pointer references the mapping
+ * directly, so loading does not copy weights and quantized tensors stay quantized.
+ * The tensors remain valid for as long as the file is open.
+ */
+class GGUFModelFile {
+public:
+    /**
+     * @brief Constructor for GGUFModelFile
+     */
+    GGUFModelFile();
+
+    /**
+     * @brief Destructor, unmaps the file
+     */
+    ~GGUFModelFile();
+
+    GGUFModelFile(const GGUFModelFile&) = delete;
+    GGUFModelFile& operator=(const GGUFModelFile&) = delete;
+
+    /**
+     * @brief Check whether a file starts with the GGUF magic
+     * @param path Path to the model file
+     * @return bool True if the file is in GGUF format
+     */
+    static bool isGGUF(const std::string& path);
+
+    /**
+     * @brief Check whether a tensor type can be used by the inference engine
+     * @param type GGML tensor type
+     * @return bool True if the type is supported
+     */
+    static bool isSupportedTensorType(int type);
+
+    /**
+     * @brief Open and map a GGUF file
+     * @param path Path to the model file
+     * @return bool True if the file was opened successfully
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the file and release all metadata
+     */
+    void close();
+
+    /**
+     * @brief Check if a file is open
+     * @return bool True if a file is mapped
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Check if a metadata key exists
+     * @param key Metadata key
+     * @return bool True if the key exists
+     */
+    bool hasKey(const std::string& key) const;
+
+    /**
+     * @brief Get a string metadata value
+     * @param key Metadata key
+     * @param defaultValue Value returned if the key is missing or not a string
+     * @return std::string The metadata value
+     */
+    std::string getString(const std::string& key, const std::string& defaultValue = "") const;
+
+    /**
+     * @brief Get an integer metadata value
+     * @param key Metadata key
+     * @param defaultValue Value returned if the key is missing or not an integer
+     * @return int64_t The metadata value
+     */
+    int64_t getInt(const std::string& key, int64_t defaultValue = 0) const;
+
+    /**
+     * @brief Get a string array metadata value
+     * @param key Metadata key
+     * @return std::vector<std::string> The array, empty if the key is missing
+     */
+    std::vector<std::string> getStringArray(const std::string& key) const;
+
+    /**
+     * @brief Get a raw array metadata value
+     * @param key Metadata key
+     * @param count Number of elements in the array
+     * @return const void* Pointer to the array data, nullptr if missing
+     */
+    const void* getArrayData(const std::string& key, size_t& count) const;
+
+    /**
+     * @brief Look up a tensor by name
+     * @param name Tensor name
+     * @return ggml_tensor* The tensor, or nullptr if not present
+     */
+    struct ggml_tensor* getTensor(const std::string& name) const;
+
+    /**
+     * @brief Get the names of all tensors in the file
+     * @return std::vector<std::string> Tensor names in file order
+     */
+    std::vector<std::string> getTensorNames() const;
+
+    /**
+     * @brief Get the number of bytes mapped from the file
+     * @return size_t Size of the mapping
+     */
+    size_t getMappedBytes() const;
+
+    /**
+     * @brief Get the path of the open file
+     * @return std::string File path
+     */
+    std::string getPath() const;
+
+private:
+    std::string path_;                 ///< Path of the mapped file
+    struct gguf_context* gguf_;        ///< Parsed GGUF header and metadata
+    struct ggml_context* meta_;        ///< Tensor descriptors (no data allocated)
+    void* mapping_;                    ///< Base address of the file mapping
+    size_t mappingSize_;               ///< Size of the file mapping
+};
+
+} // namespace inference
+} // namespace koebridge
@@ -0,0 +1,111 @@
+/**
+ * @file incremental_decoder.cc
+ * @brief Implementation of the streaming detokenizer
+ */
+
+#include "inference/incremental_decoder.h"
+#include <sentencepiece_processor.h>
+#include <cstdlib>
+
+namespace koebridge {
+namespace inference {
+
+namespace {
+
+// SentencePiece's word-boundary marker, U+2581
+const std::string kWordBoundary = "\xE2\x96\x81";
+
+// Surface SentencePiece gives unknown tokens, U+2047
+const std::string kUnknownSurface = " \xE2\x81\x87 ";
+
+// Length of the longest prefix that does not end inside a UTF-8 sequence
+size_t completeUtf8Prefix(const std::string& bytes) {
+    size_t end = bytes.size();
+    // A sequence is at most four bytes, so only the tail needs checking
+    for (size_t back = 1; back <= 4 && back <= bytes.size(); ++back) {
+        const unsigned char c = static_cast<unsigned char>(bytes[bytes.size() - back]);
+        if ((c & 0xC0) == 0x80) {
+            continue;  // continuation byte, keep looking for the lead byte
+        }
+        size_t length = 1;
+        if ((c & 0xE0) == 0xC0) {
+            length = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            length = 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            length = 4;
+        }
+        if (length > back) {
+            end = bytes.size() - back;
+        }
+        break;
+    }
+    return end;
+}
+
+} // namespace
+
+IncrementalDecoder::IncrementalDecoder(InferenceEngine& engine)
+    : engine_(engine) {
+}
+
+std::string IncrementalDecoder::push(int token) {
+    auto* tokenizer = static_cast<sentencepiece::SentencePieceProcessor*>(engine_.getTokenizer());
+
+    if (!tokenizer) {
+        std::string word = engine_.detokenize({token});
+        if (word.empty()) {
+            return "";
+        }
+        pending_ += atStart_ ? word : " " + word;
+        atStart_ = false;
+        return emit();
+    }
+
+    if (token < 0 || token >= tokenizer->GetPieceSize() ||
+        tokenizer->IsControl(token) || tokenizer->IsUnused(token)) {
+        return "";
+    }
+
+    if (tokenizer->IsUnknown(token)) {
+        pending_ += kUnknownSurface;
+    } else if (tokenizer->IsByte(token)) {
+        // Byte-fallback pieces look like <0xE3>
+        const std::string& piece = tokenizer->IdToPiece(token);
+        pending_ += static_cast<char>(std::strtol(piece.substr(3, 2).c_str(), nullptr, 16));
+    } else {
+        std::string piece = tokenizer->IdToPiece(token);
+        for (size_t pos = piece.find(kWordBoundary); pos != std::string::npos;
+             pos = piece.find(kWordBoundary, pos + 1)) {
+            piece.replace(pos, kWordBoundary.size(), " ");
+        }
+        // Like a full decode, the text does not start with the first word's boundary
+        if (atStart_ && pending_.empty() && !piece.empty() && piece[0] == ' ') {
+            piece.erase(0, 1);
+        }
+        pending_ += piece;
+    }
+
+    if (!pending_.empty()) {
+        atStart_ = false;
+    }
+    return emit();
+}
+
+std::string IncrementalDecoder::flush() {
+    std::string rest;
+    rest.swap(pending_);
+    text_ += rest;
+    return rest;
+}
+
+std::string IncrementalDecoder::emit() {
+    const size_t length = completeUtf8Prefix(pending_);
+    std::string out = pending_.substr(0, length);
+    pending_.erase(0, length);
+    text_ += out;
+    return out;
+}
+
+} // namespace inference
+} // namespace koebridge
@@ -0,0 +1,64 @@
+/**
+ * @file incremental_decoder.h
+ * @brief Token-by-token detokenization for streaming output
+ */
+
+#pragma once
+
+#include <string>
+#include "inference/engine.h"
+
+namespace koebridge {
+namespace inference {
+
+/**
+ * @class IncrementalDecoder
+ * @brief Turns a stream of generated tokens into text without re-decoding from the start
+ *
+ * Each token's SentencePiece surface is appended once: word-boundary markers become
+ * spaces and byte-fallback tokens are buffered until they form complete UTF-8
+ * characters, so a multi-byte character split over several tokens is never emitted
+ * half-way. Engines without a SentencePiece model fall back to their own vocabulary.
+ */
+class IncrementalDecoder {
+public:
+    /**
+     * @brief Constructor for IncrementalDecoder
+     * @param engine Engine whose tokenizer and vocabulary decode the tokens
+     */
+    explicit IncrementalDecoder(InferenceEngine& engine);
+
+    /**
+     * @brief Decode the next token
+     * @param token Token ID
+     * @return std::string Text completed by this token, may be empty
+     */
+    std::string push(int token);
+
+    /**
+     * @brief Emit whatever is still buffered, e.g. a truncated UTF-8 sequence
+     * @return std::string Remaining text
+     */
+    std::string flush();
+
+    /**
+     * @brief Get all text emitted so far
+     * @return const std::string& Decoded text
+     */
+    const std::string& getText() const { return text_; }
+
+private:
+    /**
+     * @brief Move the complete UTF-8 prefix of the pending bytes to the output
+     * @return std::string The emitted text
+     */
+    std::string emit();
+
+    InferenceEngine& engine_;          ///< Engine providing the tokenizer
+    std::string pending_;              ///< Bytes not yet forming complete characters
+    std::string text_;                 ///< Text emitted so far
+    bool atStart_ = true;              ///< No text has been produced yet
+};
+
+} // namespace inference
+} // namespace koebridge
@@ -0,0 +1,152 @@
+/**
+ * @file language_codes.h
+ * @brief Compile-time table of the FLORES-200 language codes used by NLLB
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace koebridge {
+namespace llm {
+
+/// Number of languages NLLB-200 has a language token for
+constexpr size_t kLanguageCount = 202;
+
+/**
+ * @brief FLORES-200 language codes in NLLB vocabulary order
+ *
+ * The language tokens follow the SentencePiece pieces in this order, so the
+ * position of a code is also the offset of its token in fairseq-layout models.
+ */
+constexpr std::array<std::string_view, kLanguageCount> kLanguageCodes = {
+    "ace_Arab", "ace_Latn", "acm_Arab", "acq_Arab", "aeb_Arab", "afr_Latn", "ajp_Arab", "aka_Latn",
+    "amh_Ethi", "apc_Arab", "arb_Arab", "ars_Arab", "ary_Arab", "arz_Arab", "asm_Beng", "ast_Latn",
+    "awa_Deva", "ayr_Latn", "azb_Arab", "azj_Latn", "bak_Cyrl", "bam_Latn", "ban_Latn", "bel_Cyrl",
+    "bem_Latn", "ben_Beng", "bho_Deva", "bjn_Arab", "bjn_Latn", "bod_Tibt", "bos_Latn", "bug_Latn",
+    "bul_Cyrl", "cat_Latn", "ceb_Latn", "ces_Latn", "cjk_Latn", "ckb_Arab", "crh_Latn", "cym_Latn",
+    "dan_Latn", "deu_Latn", "dik_Latn", "dyu_Latn", "dzo_Tibt", "ell_Grek", "eng_Latn", "epo_Latn",
+    "est_Latn", "eus_Latn", "ewe_Latn", "fao_Latn", "pes_Arab", "fij_Latn", "fin_Latn", "fon_Latn",
+    "fra_Latn", "fur_Latn", "fuv_Latn", "gla_Latn", "gle_Latn", "glg_Latn", "grn_Latn", "guj_Gujr",
+    "hat_Latn", "hau_Latn", "heb_Hebr", "hin_Deva", "hne_Deva", "hrv_Latn", "hun_Latn", "hye_Armn",
+    "ibo_Latn", "ilo_Latn", "ind_Latn", "isl_Latn", "ita_Latn", "jav_Latn", "jpn_Jpan", "kab_Latn",
+    "kac_Latn", "kam_Latn", "kan_Knda", "kas_Arab", "kas_Deva", "kat_Geor", "knc_Arab", "knc_Latn",
+    "kaz_Cyrl", "kbp_Latn", "kea_Latn", "khm_Khmr", "kik_Latn", "kin_Latn", "kir_Cyrl", "kmb_Latn",
+    "kon_Latn", "kor_Hang", "kmr_Latn", "lao_Laoo", "lvs_Latn", "lij_Latn", "lim_Latn", "lin_Latn",
+    "lit_Latn", "lmo_Latn", "ltg_Latn", "ltz_Latn", "lua_Latn", "lug_Latn", "luo_Latn", "lus_Latn",
+    "mag_Deva", "mai_Deva", "mal_Mlym", "mar_Deva", "min_Latn", "mkd_Cyrl", "plt_Latn", "mlt_Latn",
+    "mni_Beng", "khk_Cyrl", "mos_Latn", "mri_Latn", "zsm_Latn", "mya_Mymr", "nld_Latn", "nno_Latn",
+    "nob_Latn", "npi_Deva", "nso_Latn", "nus_Latn", "nya_Latn", "oci_Latn", "gaz_Latn", "ory_Orya",
+    "pag_Latn", "pan_Guru", "pap_Latn", "pol_Latn", "por_Latn", "prs_Arab", "pbt_Arab", "quy_Latn",
+    "ron_Latn", "run_Latn", "rus_Cyrl", "sag_Latn", "san_Deva", "sat_Beng", "scn_Latn", "shn_Mymr",
+    "sin_Sinh", "slk_Latn", "slv_Latn", "smo_Latn", "sna_Latn", "snd_Arab", "som_Latn", "sot_Latn",
+    "spa_Latn", "als_Latn", "srd_Latn", "srp_Cyrl", "ssw_Latn", "sun_Latn", "swe_Latn", "swh_Latn",
+    "szl_Latn", "tam_Taml", "tat_Cyrl", "tel_Telu", "tgk_Cyrl", "tgl_Latn", "tha_Thai", "tir_Ethi",
+    "taq_Latn", "taq_Tfng", "tpi_Latn", "tsn_Latn", "tso_Latn", "tuk_Latn", "tum_Latn", "tur_Latn",
+    "twi_Latn", "tzm_Tfng", "uig_Arab", "ukr_Cyrl", "umb_Latn", "urd_Arab", "uzn_Latn", "vec_Latn",
+    "vie_Latn", "war_Latn", "wol_Latn", "xho_Latn", "ydd_Hebr", "yor_Latn", "yue_Hant", "zho_Hans",
+    "zho_Hant", "zul_Latn"
+};
+
+/**
+ * @brief Short ISO 639-1 codes accepted in place of the FLORES code
+ */
+constexpr std::array<std::pair<std::string_view, std::string_view>, 10> kLanguageAliases = {{
+    {"de", "deu_Latn"}, {"en", "eng_Latn"}, {"es", "spa_Latn"}, {"fr", "fra_Latn"}, {"it", "ita_Latn"},
+    {"ja", "jpn_Jpan"}, {"ko", "kor_Hang"}, {"pt", "por_Latn"}, {"ru", "rus_Cyrl"}, {"zh", "zho_Hans"}
+}};
+
+namespace detail {
+
+/**
+ * @brief Pack an 8-character language code into an integer that sorts like the string
+ * @param code Language code
+ * @return uint64_t Big-endian packed code, 0 if the code is not 8 characters long
+ */
+constexpr uint64_t packLanguageCode(std::string_view code) {
+    if (code.size() != 8) {
+        return 0;
+    }
+    uint64_t packed = 0;
+    for (char c : code) {
+        packed = (packed << 8) | static_cast<unsigned char>(c);
+    }
+    return packed;
+}
+
+struct PackedLanguage {
+    uint64_t code;
+    int index;
+};
+
+constexpr std::array<PackedLanguage, kLanguageCount> sortLanguageCodes() {
+    std::array<PackedLanguage, kLanguageCount> sorted{};
+    for (size_t i = 0; i < kLanguageCount; ++i) {
+        sorted[i] = {packLanguageCode(kLanguageCodes[i]), static_cast<int>(i)};
+    }
+    // Insertion sort, std::sort is not constexpr before C++20
+    for (size_t i = 1; i < kLanguageCount; ++i) {
+        PackedLanguage entry = sorted[i];
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1].code > entry.code; --j) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = entry;
+    }
+    return sorted;
+}
+
+/// Packed codes sorted for binary search, built at compile time
+constexpr std::array<PackedLanguage, kLanguageCount> kSortedLanguages = sortLanguageCodes();
+
+} // namespace detail
+
+/**
+ * @brief Look up the position of a language in kLanguageCodes
+ *
+ * Accepts the FLORES code (jpn_Jpan), its vocabulary form (__jpn_Jpan__) or one
+ * of the short aliases (ja). Lookups are a binary search over packed integers and
+ * never allocate.
+ *
+ * @param code Language code
+ * @return int Index into kLanguageCodes, -1 if the language is unknown
+ */
+constexpr int languageIndex(std::string_view code) {
+    if (code.size() > 4 && code.substr(0, 2) == "__" && code.substr(code.size() - 2) == "__") {
+        code = code.substr(2, code.size() - 4);
+    }
+    for (const auto& alias : kLanguageAliases) {
+        if (alias.first == code) {
+            code = alias.second;
+            break;
+        }
+    }
+
+    const uint64_t packed = detail::packLanguageCode(code);
+    if (packed == 0) {
+        return -1;
+    }
+    size_t low = 0;
+    size_t high = kLanguageCount;
+    while (low < high) {
+        const size_t mid = (low + high) / 2;
+        if (detail::kSortedLanguages[mid].code < packed) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < kLanguageCount && detail::kSortedLanguages[low].code == packed
+        ? detail::kSortedLanguages[low].index : -1;
+}
+
+static_assert(languageIndex("ace_Arab") == 0, "language table out of order");
+static_assert(languageIndex("__jpn_Jpan__") == languageIndex("ja"), "language aliases broken");
+static_assert(languageIndex("zul_Latn") == kLanguageCount - 1, "language table out of order");
+
+} // namespace llm
+} // namespace koebridge
@@ -7,6 +7,7 @@
 #include "utils/config.h"
 #include "utils/logger.h"
 #include "llm/nllb_model.h"
+#include <algorithm>
 #include <iostream>
 
 namespace koebridge {
@@ -14,6 +15,8 @@ namespace llm {
 
 LLMManager::LLMManager(std::shared_ptr<translation::ModelManager> modelManager)
     : modelManager_(modelManager), initialized_(false) {
+    const int budgetMb = utils::Config::getInstance().getInt("translation.memory_budget_mb", 4096);
+    memoryBudget_ = static_cast<size_t>(std::max(0, budgetMb)) << 20;
 }
 
 LLMManager::~LLMManager() {
@@ -47,62 +50,292 @@ bool LLMManager::loadModel(const std::string& modelId, const LLMConfig& config)
         return false;
     }
 
-    // First, have the model manager load the model
-    if (!modelManager_->loadModel(modelId)) {
-        std::cerr << "Failed to load model: " << modelId << std::endl;
+    translation::ModelInfo info;
+    std::shared_ptr<LLMModel> model = residentModel(modelId, config, info);
+    if (!model) {
         return false;
     }
 
-    // Get the model info
-    activeModel_ = modelManager_->getActiveModel();
-    config_ = config;
+    std::shared_ptr<LLMModel> draft;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        model_ = model;
+        activeModel_ = info;
+        config_ = config;
+        draft = draftModel_;
+        evictToBudget();
+    }
+
+    // Speculative decoding is an optimization, the main model works without it
+    std::string draftId = utils::Config::getInstance().getString("translation.draft_model", "");
+    if (!draft && !draftId.empty() && draftId != modelId) {
+        loadDraftModel(draftId);
+    }
+    return true;
+}
+
+std::shared_ptr<LLMModel> LLMManager::acquireModel(const std::string& modelId) {
+    if (!initialized_) {
+        std::cerr << "LLM manager not initialized" << std::endl;
+        return nullptr;
+    }
+
+    translation::ModelInfo info;
+    std::shared_ptr<LLMModel> model = residentModel(modelId, getConfig(), info);
+    if (model) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evictToBudget();
+    }
+    return model;
+}
+
+std::shared_ptr<LLMModel> LLMManager::residentModel(const std::string& modelId, const LLMConfig& config,
+                                                    translation::ModelInfo& info) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ResidentModel* resident = touchResident(modelId)) {
+            info = resident->info;
+            return resident->model;
+        }
+    }
+
+    // Resident models keep serving while another one loads
+    std::lock_guard<std::mutex> loadLock(loadMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ResidentModel* resident = touchResident(modelId)) {
+            info = resident->info;
+            return resident->model;
+        }
+    }
+
+    // Resident models are created directly, so the model manager does not reload its own model
+    std::vector<translation::ModelInfo> models = modelManager_->getAvailableModels();
+    auto it = std::find_if(models.begin(), models.end(), [&](const translation::ModelInfo& candidate) {
+        return candidate.id == modelId;
+    });
+    if (it == models.end()) {
+        std::cerr << "Failed to load model: " << modelId << std::endl;
+        return nullptr;
+    }
 
     // Create the LLM model
-    model_ = createModel(activeModel_, config_);
-    if (!model_) {
+    std::shared_ptr<LLMModel> model = createModel(*it, config);
+    if (!model) {
         std::cerr << "Failed to create LLM model: " << modelId << std::endl;
-        return false;
+        return nullptr;
     }
 
     // Initialize the model
-    if (!model_->initialize()) {
+    if (!model->initialize()) {
         std::cerr << "Failed to initialize LLM model: " << modelId << std::endl;
-        model_.reset();
+        return nullptr;
+    }
+
+    ResidentModel resident;
+    resident.info = *it;
+    resident.model = model;
+    resident.bytes = model->getMemoryBytes();
+    if (resident.bytes == 0) {
+        resident.bytes = it->size;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (draftModel_) {
+        model->setDraftModel(draftModel_);
+    }
+    residents_.push_front(std::move(resident));
+    info = *it;
+
+    std::cout << "Loaded LLM model: " << modelId << " ("
+              << (residents_.front().bytes >> 20) << " MB, "
+              << residents_.size() << " resident)" << std::endl;
+    return model;
+}
+
+LLMManager::ResidentModel* LLMManager::touchResident(const std::string& modelId) {
+    auto it = std::find_if(residents_.begin(), residents_.end(), [&](const ResidentModel& resident) {
+        return resident.info.id == modelId;
+    });
+    if (it == residents_.end()) {
+        return nullptr;
+    }
+    residents_.splice(residents_.begin(), residents_, it);
+    return &residents_.front();
+}
+
+void LLMManager::evictToBudget() {
+    if (memoryBudget_ == 0) {
+        return;
+    }
+
+    size_t total = draftModel_ ? draftModel_->getMemoryBytes() : 0;
+    for (const ResidentModel& resident : residents_) {
+        total += resident.bytes;
+    }
+
+    // Walk from the least recently used end, skipping the models in use
+    auto it = residents_.end();
+    while (total > memoryBudget_ && it != residents_.begin()) {
+        --it;
+        if (it == residents_.begin() || it->model == model_) {
+            continue;
+        }
+        std::cout << "Evicting LLM model: " << it->info.id << std::endl;
+        total -= it->bytes;
+        it = residents_.erase(it);
+    }
+
+    if (total > memoryBudget_) {
+        LOG_WARNING("Resident models use " + std::to_string(total >> 20) + " MB, over the " +
+                    std::to_string(memoryBudget_ >> 20) + " MB budget");
+    }
+}
+
+std::vector<translation::ModelInfo> LLMManager::getResidentModels() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<translation::ModelInfo> models;
+    models.reserve(residents_.size());
+    for (const ResidentModel& resident : residents_) {
+        models.push_back(resident.info);
+    }
+    return models;
+}
+
+size_t LLMManager::getResidentBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = draftModel_ ? draftModel_->getMemoryBytes() : 0;
+    for (const ResidentModel& resident : residents_) {
+        total += resident.bytes;
+    }
+    return total;
+}
+
+void LLMManager::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memoryBudget_ = bytes;
+    evictToBudget();
+}
+
+size_t LLMManager::getMemoryBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memoryBudget_;
+}
+
+bool LLMManager::loadDraftModel(const std::string& modelId) {
+    if (!initialized_) {
+        std::cerr << "LLM manager not initialized" << std::endl;
         return false;
     }
 
-    std::cout << "Loaded LLM model: " << modelId << std::endl;
+    // The draft is created directly so the model manager's active model stays the main one
+    std::vector<translation::ModelInfo> models = modelManager_->getAvailableModels();
+    auto it = std::find_if(models.begin(), models.end(), [&](const translation::ModelInfo& info) {
+        return info.id == modelId;
+    });
+    if (it == models.end()) {
+        std::cerr << "Draft model not found: " << modelId << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<LLMModel> draft = createModel(*it, getConfig());
+    if (!draft || !draft->initialize()) {
+        std::cerr << "Failed to initialize draft model: " << modelId << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (model_ && !model_->setDraftModel(draft)) {
+        std::cerr << "Draft model " << modelId << " cannot draft for " << activeModel_.id << std::endl;
+        return false;
+    }
+
+    // Other resident models sharing the vocabulary use the draft too
+    for (ResidentModel& resident : residents_) {
+        if (resident.model != model_) {
+            resident.model->setDraftModel(draft);
+        }
+    }
+
+    draftModel_ = draft;
+    std::cout << "Loaded draft model: " << modelId << std::endl;
+    evictToBudget();
     return true;
 }
 
+void LLMManager::unloadDraftModel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (ResidentModel& resident : residents_) {
+        resident.model->setDraftModel(nullptr);
+    }
+    draftModel_.reset();
+}
+
+std::shared_ptr<LLMModel> LLMManager::getDraftModel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return draftModel_;
+}
+
 bool LLMManager::unloadModel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (model_) {
+        residents_.remove_if([this](const ResidentModel& resident) {
+            return resident.model == model_;
+        });
+    }
     model_.reset();
+    activeModel_ = translation::ModelInfo{};
     return true;
 }
 
 bool LLMManager::isModelLoaded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return model_ != nullptr && model_->isInitialized();
 }
 
 translation::ModelInfo LLMManager::getActiveModel() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return activeModel_;
 }
 
 std::shared_ptr<LLMModel> LLMManager::getModel() {
+    std::lock_guard<std::mutex> lock(mutex_);
     return model_;
 }
 
 LLMOutput LLMManager::complete(const std::string& prompt) {
     LLMOutput output;
 
-    if (!isModelLoaded()) {
+    // The request holds its own reference, so an eviction cannot pull the model away
+    std::shared_ptr<LLMModel> model = getModel();
+    if (!model || !model->isInitialized()) {
         output.success = false;
         output.errorMessage = "No LLM model loaded";
         return output;
     }
 
     try {
-        output = model_->complete(prompt);
+        output = model->complete(prompt);
+    } catch (const std::exception& e) {
+        output.success = false;
+        output.errorMessage = std::string("Error during completion: ") + e.what();
+    }
+
+    return output;
+}
+
+LLMOutput LLMManager::complete(const std::string& modelId, const std::string& prompt) {
+    LLMOutput output;
+
+    std::shared_ptr<LLMModel> model = acquireModel(modelId);
+    if (!model) {
+        output.success = false;
+        output.errorMessage = "Failed to load LLM model: " + modelId;
+        return output;
+    }
+
+    try {
+        output = model->complete(prompt);
     } catch (const std::exception& e) {
         output.success = false;
         output.errorMessage = std::string("Error during completion: ") + e.what();
@@ -112,7 +345,8 @@ LLMOutput LLMManager::complete(const std::string& prompt) {
 }
 
 std::future<LLMOutput> LLMManager::completeAsync(const std::string& prompt) {
-    if (!isModelLoaded()) {
+    std::shared_ptr<LLMModel> model = getModel();
+    if (!model || !model->isInitialized()) {
         auto future = std::async(std::launch::deferred, []() {
             LLMOutput output;
             output.success = false;
@@ -122,17 +356,21 @@ std::future<LLMOutput> LLMManager::completeAsync(const std::string& prompt) {
         return future;
     }
 
-    return model_->completeAsync(prompt);
+    // The call holds its own reference, so an eviction cannot pull the model away, and
+    // no pool thread waits while the model's scheduler decodes
+    return model->completeAsync(prompt);
 }
 
 void LLMManager::setConfig(const LLMConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
     config_ = config;
-    if (model_) {
-        model_->setConfig(config);
+    for (ResidentModel& resident : residents_) {
+        resident.model->setConfig(config);
     }
 }
 
 LLMConfig LLMManager::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return config_;
 }
 
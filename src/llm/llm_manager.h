@@ -9,6 +9,8 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <list>
+#include <mutex>
 #include "llm/llm_model.h"
 #include "translation/model_manager.h"
 
@@ -21,6 +23,11 @@ namespace llm {
  *
  * This class manages the lifecycle of LLM models, providing a high-level interface
  * for model loading, configuration, and text generation operations.
+ *
+ * Loaded models stay resident until their weights no longer fit the memory budget
+ * (translation.memory_budget_mb), at which point the least recently used models are
+ * released. Switching back to a resident model is then free. Requests that are still
+ * running keep their model alive until they finish.
  */
 class LLMManager {
 public:
@@ -42,7 +49,10 @@ public:
     bool initialize();
 
     /**
-     * @brief Load an LLM model by ID
+     * @brief Load an LLM model by ID and make it the active model
+     *
+     * A model that is already resident is activated without reloading.
+     *
      * @param modelId ID of the model to load
      * @param config Configuration options for the model
      * @return bool True if model was loaded successfully
@@ -50,11 +60,72 @@ public:
     bool loadModel(const std::string& modelId, const LLMConfig& config = LLMConfig());
 
     /**
-     * @brief Unload the currently loaded model
+     * @brief Unload the active model
      * @return bool True if unloaded successfully
      */
     bool unloadModel();
 
+    /**
+     * @brief Get a model by ID, loading it if it is not resident
+     *
+     * The active model is left unchanged.
+     *
+     * @param modelId ID of the model
+     * @return std::shared_ptr<LLMModel> The model, nullptr if it could not be loaded
+     */
+    std::shared_ptr<LLMModel> acquireModel(const std::string& modelId);
+
+    /**
+     * @brief Get information about the resident models
+     * @return std::vector<translation::ModelInfo> Resident models, most recently used first
+     */
+    std::vector<translation::ModelInfo> getResidentModels() const;
+
+    /**
+     * @brief Get the memory held by the resident models and the draft model
+     * @return size_t Mapped weight bytes
+     */
+    size_t getResidentBytes() const;
+
+    /**
+     * @brief Set the memory budget for resident models
+     *
+     * Evicts least recently used models until the rest fit. The active model is never
+     * evicted, even if it alone exceeds the budget.
+     *
+     * @param bytes Budget in bytes, 0 for no limit
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * @brief Get the memory budget for resident models
+     * @return size_t Budget in bytes, 0 for no limit
+     */
+    size_t getMemoryBudget() const;
+
+    /**
+     * @brief Load a smaller model that drafts tokens for the main model
+     *
+     * The draft must share the main model's vocabulary, e.g. a distilled NLLB-600M
+     * drafting for NLLB-1.3B. It stays paired across main model reloads. loadModel()
+     * also loads the draft named by translation.draft_model in the configuration.
+     *
+     * @param modelId ID of the draft model
+     * @return bool True if the draft was loaded and paired with the main model
+     */
+    bool loadDraftModel(const std::string& modelId);
+
+    /**
+     * @brief Unload the draft model, returning to plain decoding
+     */
+    void unloadDraftModel();
+
+    /**
+     * @brief Get the loaded draft model
+     * @return std::shared_ptr<LLMModel> The draft model, nullptr if none is loaded
+     */
+    std::shared_ptr<LLMModel> getDraftModel();
+
     /**
      * @brief Check if a model is loaded
      * @return bool True if a model is loaded
@@ -80,6 +151,14 @@ public:
      */
     LLMOutput complete(const std::string& prompt);
 
+    /**
+     * @brief Generate text completion with a specific model
+     * @param modelId ID of the model, loaded if it is not resident
+     * @param prompt The input prompt
+     * @return LLMOutput The generated completion
+     */
+    LLMOutput complete(const std::string& modelId, const std::string& prompt);
+
     /**
      * @brief Generate text completion asynchronously
      * @param prompt The input prompt
@@ -100,11 +179,26 @@ public:
     LLMConfig getConfig() const;
 
 private:
+    /**
+     * @struct ResidentModel
+     * @brief A loaded model and the memory its weights occupy
+     */
+    struct ResidentModel {
+        translation::ModelInfo info;           ///< Model information
+        std::shared_ptr<LLMModel> model;       ///< The loaded model
+        size_t bytes = 0;                      ///< Mapped weight bytes
+    };
+
     std::shared_ptr<translation::ModelManager> modelManager_; ///< Translation model manager
-    std::shared_ptr<LLMModel> model_;                        ///< Currently loaded LLM model
+    std::shared_ptr<LLMModel> model_;                        ///< Currently active LLM model
+    std::shared_ptr<LLMModel> draftModel_;                   ///< Draft model for speculative decoding
     bool initialized_;                                       ///< Initialization state
     translation::ModelInfo activeModel_;                     ///< Currently active model info
     LLMConfig config_;                                       ///< Current configuration
+    std::list<ResidentModel> residents_;                     ///< Resident models, most recently used first
+    size_t memoryBudget_ = 0;                                ///< Budget for resident weights, 0 for no limit
+    mutable std::mutex mutex_;                               ///< Guards the models, residents_ and config_
+    std::mutex loadMutex_;                                   ///< Serializes model loads
 
     /**
      * @brief Create an LLM model instance for the given model info
@@ -113,6 +207,30 @@ private:
      * @return std::shared_ptr<LLMModel> Shared pointer to the created model
      */
     std::shared_ptr<LLMModel> createModel(const translation::ModelInfo& modelInfo, const LLMConfig& config);
+
+    /**
+     * @brief Find a resident model and mark it as most recently used
+     * @param modelId ID of the model
+     * @return ResidentModel* The resident entry, nullptr if not resident; guarded by mutex_
+     */
+    ResidentModel* touchResident(const std::string& modelId);
+
+    /**
+     * @brief Return a resident model or load it and make it resident
+     * @param modelId ID of the model
+     * @param config Configuration for a newly loaded model
+     * @param info Receives the model information
+     * @return std::shared_ptr<LLMModel> The model, nullptr if it could not be loaded
+     */
+    std::shared_ptr<LLMModel> residentModel(const std::string& modelId, const LLMConfig& config,
+                                            translation::ModelInfo& info);
+
+    /**
+     * @brief Release least recently used models until the rest fit the budget
+     *
+     * The active model and the model just used are kept. Requires mutex_.
+     */
+    void evictToBudget();
 };
 
 } // namespace llm
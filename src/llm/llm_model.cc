@@ -4,8 +4,11 @@
  */
 
 #include "llm/llm_model.h"
+#include "inference/incremental_decoder.h"
 #include "utils/config.h"
 #include "utils/logger.h"
+#include "utils/random.h"
+#include "utils/text_normalizer.h"
 #include <iostream>
 #include <future>
 #include <algorithm>
@@ -14,13 +17,22 @@
 namespace koebridge {
 namespace llm {
 
+namespace {
+
+// Utterances longer than this rarely repeat verbatim and are not cached
+constexpr size_t kMaxCachedTextBytes = 256;
+
+} // namespace
+
 LLMModel::LLMModel(const translation::ModelInfo& modelInfo, const LLMConfig& config)
-    : GGMLModel(modelInfo), config_(config) {
+    : GGMLModel(modelInfo), config_(config), tokenCache_(config.tokenCacheSize) {
     // Additional initialization for LLM-specific parameters will be done in initialize()
 }
 
 LLMModel::~LLMModel() {
-    // Cleanup will be handled by the base class
+    // Pending completions use the scheduler, then stop it before the base class releases the engine
+    waitForAsyncCalls();
+    scheduler_.reset();
 }
 
 bool LLMModel::initialize() {
@@ -36,10 +48,13 @@ bool LLMModel::initialize() {
     // - Set up device-specific optimizations (GPU, etc)
     // - Load additional resources like special tokens
 
+    engine_->setNumThreads(config_.numThreads);
+
     std::cout << "LLM model initialized with config: "
               << "context size=" << config_.contextSize
               << ", temperature=" << config_.temperature
-              << ", threads=" << config_.numThreads << std::endl;
+              << ", threads=" << config_.numThreads
+              << ", batch size=" << config_.maxBatchSize << std::endl;
 
     return true;
 }
@@ -48,13 +63,16 @@ LLMOutput LLMModel::complete(const std::string& prompt) {
     LLMOutput output;
     translation::InferenceStats stats;
 
+    // Every request samples from its own generator; a fixed seed replays it exactly
+    output.seed = config_.seed >= 0 ? static_cast<uint64_t>(config_.seed) : utils::Xoshiro256::randomSeed();
+
     try {
         // Format the prompt for the model
         std::string formattedPrompt = formatPrompt(prompt);
 
         // Run the generation
         std::vector<int> outputTokens;
-        if (runGeneration(formattedPrompt, outputTokens, stats)) {
+        if (runGeneration(formattedPrompt, outputTokens, stats, output.seed)) {
             // Convert tokens back to text using our local method
             output.text = localDetokenize(outputTokens);
             output.success = true;
@@ -72,144 +90,371 @@ LLMOutput LLMModel::complete(const std::string& prompt) {
 }
 
 std::future<LLMOutput> LLMModel::completeAsync(const std::string& prompt) {
-    // TODO: Implement with proper thread pool management
-    return std::async(std::launch::async, [this, prompt]() {
-        return complete(prompt);
+    auto promise = std::make_shared<std::promise<LLMOutput>>();
+    std::future<LLMOutput> future = promise->get_future();
+
+    // Pool threads only tokenize and detokenize, no thread waits while the scheduler decodes
+    runAsync([this, self = weak_from_this().lock(), prompt, promise]() {
+        LLMOutput output;
+        output.seed = config_.seed >= 0 ? static_cast<uint64_t>(config_.seed) : utils::Xoshiro256::randomSeed();
+        if (!isInitialized()) {
+            output.errorMessage = "Generation failed";
+            promise->set_value(std::move(output));
+            return;
+        }
+
+        try {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            std::vector<int> promptTokens = tokenizePrompt(formatPrompt(prompt));
+            output.stats.inputTokenCount = promptTokens.size();
+            inference::SequenceRequest request = buildPromptRequest(std::move(promptTokens), output.seed);
+            const size_t contextSize = request.promptTokens.size();
+
+            submitDetached(std::move(request), [this, output, contextSize, startTime, promise](
+                                                   inference::SequenceResult result) mutable {
+                try {
+                    std::vector<int> outputTokens;
+                    if (collectGeneration(std::move(result), contextSize, startTime, outputTokens, output.stats)) {
+                        output.text = localDetokenize(outputTokens);
+                        output.success = true;
+                    } else {
+                        output.errorMessage = "Generation failed";
+                    }
+                } catch (const std::exception& e) {
+                    output.success = false;
+                    output.errorMessage = std::string("Error during generation: ") + e.what();
+                }
+                promise->set_value(std::move(output));
+            });
+        } catch (const std::exception& e) {
+            output.errorMessage = std::string("Error during generation: ") + e.what();
+            promise->set_value(std::move(output));
+        }
     });
+    return future;
 }
 
-void LLMModel::setConfig(const LLMConfig& config) {
-    config_ = config;
-}
+LLMOutput LLMModel::completeStream(const std::string& prompt, const translation::TranslationStreamCallback& callback) {
+    LLMOutput output;
+    translation::InferenceStats stats;
+    output.seed = config_.seed >= 0 ? static_cast<uint64_t>(config_.seed) : utils::Xoshiro256::randomSeed();
 
-LLMConfig LLMModel::getConfig() const {
-    return config_;
+    try {
+        std::string formattedPrompt = formatPrompt(prompt);
+
+        // Decode every token once as it arrives instead of the whole sequence at the end
+        inference::IncrementalDecoder decoder(*engine_);
+        const int eosToken = 2;
+        auto onToken = [&](int token) {
+            if (token == eosToken) {
+                return true;
+            }
+            std::string piece = decoder.push(token);
+            return piece.empty() || !callback || callback(piece);
+        };
+
+        std::vector<int> outputTokens;
+        if (runGeneration(formattedPrompt, outputTokens, stats, output.seed, onToken)) {
+            std::string rest = decoder.flush();
+            if (!rest.empty() && callback) {
+                callback(rest);
+            }
+            output.text = decoder.getText();
+            output.success = true;
+            output.stats = stats;
+        } else {
+            output.success = false;
+            output.errorMessage = "Generation failed";
+        }
+    } catch (const std::exception& e) {
+        output.success = false;
+        output.errorMessage = std::string("Error during generation: ") + e.what();
+    }
+
+    return output;
 }
 
-bool LLMModel::runGeneration(const std::string& prompt, std::vector<int>& output, translation::InferenceStats& stats) {
+translation::TranslationResult LLMModel::translateStream(const std::string& text,
+                                                        const translation::TranslationOptions& options,
+                                                        const translation::TranslationStreamCallback& callback) {
+    translation::TranslationResult result;
+    result.sourceText = text;
+
     if (!isInitialized()) {
-        std::cerr << "LLM model not initialized" << std::endl;
-        return false;
+        result.success = false;
+        result.errorMessage = "Model not initialized";
+        return result;
+    }
+    if (isStopped(options)) {
+        markInterrupted(options, result);
+        return result;
     }
 
-    auto startTime = std::chrono::high_resolution_clock::now();
+    try {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        const uint64_t seed = config_.seed >= 0 ? static_cast<uint64_t>(config_.seed) : utils::Xoshiro256::randomSeed();
+
+        // The scheduler decodes the sequence with the other requests; each token is
+        // decoded to text on the scheduler thread as soon as it is sampled
+        inference::IncrementalDecoder decoder(*engine_);
+        inference::SequenceRequest request = buildPromptRequest(tokenizePrompt(formatPrompt(text)), seed);
+        const int eosToken = request.eosToken;
+        request.onToken = [&decoder, &callback, eosToken](int token) {
+            if (token == eosToken) {
+                return true;
+            }
+            std::string piece = decoder.push(token);
+            return piece.empty() || !callback || callback(piece);
+        };
+        request.cancellation = options.cancellation;
+        const size_t promptSize = request.promptTokens.size();
+
+        inference::SequenceResult sequence = submitRequest(std::move(request)).get();
+        if (!sequence.success && !sequence.interrupted) {
+            result.success = false;
+            result.errorMessage = "Generation failed: " + sequence.errorMessage;
+            return result;
+        }
 
-    // Tokenize the prompt
-    std::vector<int> promptTokens = localTokenize(prompt);
-    stats.inputTokenCount = promptTokens.size();
+        std::string rest = decoder.flush();
+        if (!rest.empty() && callback) {
+            callback(rest);
+        }
 
-    // Set up the context window
-    size_t maxContextSize = std::min(config_.contextSize, static_cast<int>(promptTokens.size() + config_.maxLength));
-    std::vector<int> contextTokens(promptTokens.begin(), promptTokens.begin() + maxContextSize);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        result.text = decoder.getText();
+        result.success = true;
+        result.metrics.totalTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+        result.metrics.inferenceTimeMs = sequence.decodeTimeMs;
+        result.metrics.inputTokenCount = promptSize;
+        result.metrics.outputTokenCount = sequence.tokens.size() - std::min(sequence.tokens.size(), promptSize);
+        if (sequence.interrupted) {
+            markInterrupted(options, result);
+        }
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.errorMessage = std::string("Translation error: ") + e.what();
+    }
 
-    // Initialize output vector with context
-    output = contextTokens;
+    return result;
+}
 
-    // Run inference through GGML
-    auto inferenceStartTime = std::chrono::high_resolution_clock::now();
+void LLMModel::setConfig(const LLMConfig& config) {
+    config_ = config;
+    tokenCache_.setCapacity(config_.tokenCacheSize);
+    if (engine_) {
+        engine_->setNumThreads(config_.numThreads);
+    }
+}
 
-    // Generate tokens one by one
-    for (int i = 0; i < config_.maxLength; ++i) {
-        // Get next token probabilities
-        std::vector<float> logits = engine_->getLogits();
+LLMConfig LLMModel::getConfig() const {
+    return config_;
+}
 
-        // Apply temperature
-        if (config_.temperature > 0) {
-            for (float& logit : logits) {
-                logit /= config_.temperature;
-            }
+bool LLMModel::setDraftModel(std::shared_ptr<LLMModel> draft) {
+    if (draft) {
+        if (draft.get() == this || !draft->isInitialized()) {
+            LOG_ERROR("Draft model must be a different, initialized model");
+            return false;
         }
-
-        // Apply top-k filtering
-        if (config_.topK > 0) {
-            std::vector<std::pair<float, int>> logitIndexPairs;
-            for (size_t j = 0; j < logits.size(); ++j) {
-                logitIndexPairs.emplace_back(logits[j], j);
-            }
-            std::partial_sort(logitIndexPairs.begin(),
-                            logitIndexPairs.begin() + config_.topK,
-                            logitIndexPairs.end(),
-                            std::greater<>());
-
-            // Zero out probabilities for tokens not in top-k
-            for (size_t j = config_.topK; j < logitIndexPairs.size(); ++j) {
-                logits[logitIndexPairs[j].second] = -INFINITY;
-            }
+        // Proposed token IDs are fed straight into this model
+        if (draft->engine_->getVocabSize() != engine_->getVocabSize()) {
+            LOG_ERROR("Draft model " + draft->getModelInfo().id + " has a different vocabulary than " +
+                      modelInfo_.id);
+            return false;
         }
+    }
 
-        // Apply top-p (nucleus) sampling
-        if (config_.topP < 1.0f) {
-            std::vector<float> sortedLogits = logits;
-            std::sort(sortedLogits.begin(), sortedLogits.end(), std::greater<>());
+    // One proposer per draft, so the scheduler batches the proposals of every sequence using it
+    std::shared_ptr<const inference::DraftProposer> proposer;
+    if (draft) {
+        proposer = std::make_shared<const inference::DraftProposer>(
+            [draft](const std::vector<const std::vector<int>*>& histories, const std::vector<int>& maxTokens) {
+                return draft->proposeTokens(histories, maxTokens);
+            });
+    }
 
-            float cumulativeProb = 0.0f;
-            float threshold = -INFINITY;
+    std::lock_guard<std::mutex> lock(draftMutex_);
+    draft_ = std::move(draft);
+    draftProposer_ = std::move(proposer);
+    return true;
+}
 
-            for (float logit : sortedLogits) {
-                float prob = std::exp(logit);
-                cumulativeProb += prob;
-                if (cumulativeProb >= config_.topP) {
-                    threshold = logit;
-                    break;
-                }
-            }
+std::shared_ptr<LLMModel> LLMModel::getDraftModel() const {
+    std::lock_guard<std::mutex> lock(draftMutex_);
+    return draft_;
+}
 
-            for (float& logit : logits) {
-                if (logit < threshold) {
-                    logit = -INFINITY;
-                }
-            }
-        }
+std::shared_ptr<const std::vector<int>> LLMModel::outputShortlist(const std::vector<int>& /*promptTokens*/) {
+    // General LLMs have no target language to restrict the output to
+    return nullptr;
+}
 
-        // Apply repeat penalty
-        if (config_.repeatPenalty > 1.0f) {
-            for (int token : output) {
-                logits[token] /= config_.repeatPenalty;
-            }
-        }
+std::shared_ptr<const inference::EncoderOutput> LLMModel::encodeSource(const std::vector<int>& /*promptTokens*/) {
+    // Decoder-only models condition on the prompt tokens alone
+    return nullptr;
+}
 
-        // Sample next token
-        float sum = 0.0f;
-        for (float logit : logits) {
-            sum += std::exp(logit);
-        }
+std::vector<std::vector<int>> LLMModel::proposeTokens(const std::vector<const std::vector<int>*>& histories,
+                                                      const std::vector<int>& maxTokens) {
+    if (!isInitialized()) {
+        return std::vector<std::vector<int>>(histories.size());
+    }
 
-        float r = static_cast<float>(rand()) / RAND_MAX * sum;
-        float cumsum = 0.0f;
-        int nextToken = -1;
+    // The engine keeps no KV cache, so each proposal only decodes from the last token
+    std::vector<int> lastTokens;
+    std::vector<int> budgets;
+    lastTokens.reserve(histories.size());
+    budgets.reserve(histories.size());
+    for (size_t i = 0; i < histories.size(); ++i) {
+        const bool empty = !histories[i] || histories[i]->empty();
+        lastTokens.push_back(empty ? 0 : histories[i]->back());
+        budgets.push_back(empty || i >= maxTokens.size() ? 0 : maxTokens[i]);
+    }
+    return engine_->greedyDecodeBatch(lastTokens, budgets);
+}
 
-        for (size_t j = 0; j < logits.size(); ++j) {
-            cumsum += std::exp(logits[j]);
-            if (cumsum > r) {
-                nextToken = j;
-                break;
-            }
-        }
+bool LLMModel::runGeneration(const std::string& prompt, std::vector<int>& output, translation::InferenceStats& stats,
+                             uint64_t seed, const inference::TokenCallback& onToken) {
+    if (!isInitialized()) {
+        std::cerr << "LLM model not initialized" << std::endl;
+        return false;
+    }
 
-        if (nextToken == -1) {
-            nextToken = logits.size() - 1;
-        }
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-        // Add token to output
-        output.push_back(nextToken);
+    // Tokenize the prompt
+    std::vector<int> promptTokens = tokenizePrompt(prompt);
+    stats.inputTokenCount = promptTokens.size();
 
-        // Check for end of sequence
-        if (nextToken == 2) { // EOS token
-            break;
-        }
+    // Hand the sequence to the scheduler, which decodes it together with other requests
+    inference::SequenceRequest request = buildPromptRequest(std::move(promptTokens), seed, onToken);
+    const size_t contextSize = request.promptTokens.size();
+
+    return collectGeneration(submitRequest(std::move(request)).get(), contextSize, startTime, output, stats);
+}
+
+bool LLMModel::collectGeneration(inference::SequenceResult result, size_t contextSize,
+                                 std::chrono::high_resolution_clock::time_point startTime,
+                                 std::vector<int>& output, translation::InferenceStats& stats) {
+    if (!result.success) {
+        std::cerr << "Generation failed: " << result.errorMessage << std::endl;
+        return false;
     }
+    output = std::move(result.tokens);
 
-    auto inferenceEndTime = std::chrono::high_resolution_clock::now();
     auto endTime = std::chrono::high_resolution_clock::now();
 
-    // Update statistics
-    stats.outputTokenCount = output.size() - promptTokens.size();
+    // Update statistics, inference covers the time from submission to the last token
+    stats.outputTokenCount = output.size() - contextSize;
     stats.totalTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
-    stats.inferenceTimeMs = std::chrono::duration<float, std::milli>(inferenceEndTime - inferenceStartTime).count();
+    stats.inferenceTimeMs = result.queueTimeMs + result.decodeTimeMs;
+    recordDraftStats(result, stats);
 
     return true;
 }
 
+inference::SequenceRequest LLMModel::buildRequest(std::vector<int> promptTokens, uint64_t seed,
+                                                  const inference::TokenCallback& onToken) {
+    // Set up the context window
+    size_t maxContextSize = std::min(config_.contextSize, static_cast<int>(promptTokens.size() + config_.maxLength));
+    maxContextSize = std::min(maxContextSize, promptTokens.size());
+    promptTokens.resize(maxContextSize);
+
+    SamplingParams params;
+    params.temperature = config_.temperature;
+    params.topK = config_.topK;
+    params.topP = config_.topP;
+    params.repeatPenalty = config_.repeatPenalty;
+    params.repeatWindow = config_.repeatWindow;
+    params.seed = seed;
+    auto sampler = std::make_shared<Sampler>(params);
+
+    inference::SequenceRequest request;
+    request.promptTokens = std::move(promptTokens);
+    request.maxNewTokens = config_.maxLength;
+    request.eosToken = 2; // EOS token
+    request.sampler = [sampler](inference::LogitsSpan logits, const std::vector<int>& history) {
+        return sampler->sample(logits, history);
+    };
+    request.onToken = onToken;
+
+    // The draft runs on the scheduler thread, between this model's forward passes
+    {
+        std::lock_guard<std::mutex> lock(draftMutex_);
+        request.draft = draftProposer_;
+    }
+    if (request.draft) {
+        request.draftTokens = config_.draftTokens;
+    }
+    return request;
+}
+
+inference::SequenceRequest LLMModel::buildPromptRequest(std::vector<int> promptTokens, uint64_t seed,
+                                                        const inference::TokenCallback& onToken) {
+    inference::SequenceRequest request = buildRequest(std::move(promptTokens), seed, onToken);
+    if (config_.useShortlist) {
+        request.shortlist = outputShortlist(request.promptTokens);
+    }
+    request.encoderOutput = encodeSource(request.promptTokens);
+    return request;
+}
+
+std::future<inference::SequenceResult> LLMModel::submitRequest(inference::SequenceRequest request) {
+    std::vector<inference::SequenceRequest> requests;
+    requests.push_back(std::move(request));
+    return std::move(submitRequests(std::move(requests)).front());
+}
+
+std::vector<std::future<inference::SequenceResult>> LLMModel::submitRequests(
+    std::vector<inference::SequenceRequest> requests) {
+    if (!isInitialized()) {
+        std::vector<std::future<inference::SequenceResult>> futures;
+        for (inference::SequenceRequest& request : requests) {
+            std::promise<inference::SequenceResult> failed;
+            futures.push_back(failed.get_future());
+            inference::SequenceResult result;
+            result.errorMessage = "LLM model not initialized";
+            if (request.onComplete) {
+                request.onComplete(std::move(result));
+            } else {
+                failed.set_value(std::move(result));
+            }
+        }
+        return futures;
+    }
+    // Concurrent requests share one running decode batch. The scheduler starts with the
+    // first request, so a model that only drafts for others never runs one.
+    std::call_once(schedulerStarted_, [this] {
+        scheduler_ = std::make_unique<inference::BatchScheduler>(*engine_, config_.maxBatchSize);
+        scheduler_->start();
+    });
+    return scheduler_->submitAll(std::move(requests));
+}
+
+void LLMModel::submitDetached(inference::SequenceRequest request,
+                              std::function<void(inference::SequenceResult)> onResult) {
+    // Counted like a pool call, so the destructor waits for the decode too. Only the pool
+    // task holds the model: a reference left on the scheduler thread could end up
+    // destroying the model, and its scheduler, from that very thread.
+    beginAsyncCall();
+    request.onComplete = [this, self = weak_from_this().lock(), onResult = std::move(onResult)](
+                             inference::SequenceResult result) mutable {
+        runAsync([self = std::move(self), onResult = std::move(onResult), result = std::move(result)]() mutable {
+            onResult(std::move(result));
+        });
+        finishAsyncCall();
+    };
+    submitRequest(std::move(request));
+}
+
+void LLMModel::recordDraftStats(const inference::SequenceResult& result, translation::InferenceStats& stats) {
+    stats.draftTokenCount = static_cast<int>(result.draftTokensProposed);
+    stats.acceptedDraftTokenCount = static_cast<int>(result.draftTokensAccepted);
+    stats.draftAcceptanceRate = result.draftTokensProposed == 0 ? 0.0 :
+        static_cast<double>(result.draftTokensAccepted) / result.draftTokensProposed;
+}
+
 std::string LLMModel::formatPrompt(const std::string& prompt) {
     std::string modelType = modelInfo_.modelType;
 
@@ -226,6 +471,43 @@ std::string LLMModel::formatPrompt(const std::string& prompt) {
 }
 
 std::vector<int> LLMModel::localTokenize(const std::string& text) {
+    return tokenizeCached(text, std::string(), [this](const std::string& uncached) {
+        return encodeText(uncached);
+    });
+}
+
+std::vector<int> LLMModel::tokenizePrompt(const std::string& prompt) {
+    return localTokenize(prompt);
+}
+
+std::vector<int> LLMModel::tokenizeCached(const std::string& text, const std::string& keyPrefix,
+                                          const std::function<std::vector<int>(const std::string&)>& encode) {
+    // The normalized text is what gets encoded, so a cached entry is a function of its key
+    // alone and does not depend on the spacing of whichever variant filled it
+    const std::string normalized = utils::normalizeWhitespace(text);
+    if (normalized.size() > kMaxCachedTextBytes) {
+        return encode(normalized);
+    }
+
+    const std::string key = keyPrefix + normalized;
+    std::vector<int> tokens;
+    if (tokenCache_.get(key, tokens)) {
+        return tokens;
+    }
+
+    tokens = encode(normalized);
+    // Without a tokenizer only BOS comes back, which must not outlive a later load
+    if (engine_->getTokenizer()) {
+        tokenCache_.put(key, tokens);
+    }
+    return tokens;
+}
+
+utils::CacheStats LLMModel::getTokenCacheStats() const {
+    return tokenCache_.getStats();
+}
+
+std::vector<int> LLMModel::encodeText(const std::string& text) {
     std::vector<int> tokens;
 
     // Add BOS token
@@ -9,10 +9,17 @@
 #include <memory>
 #include <future>
 #include <vector>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <functional>
 #include "models/ggml_model.h"
 #include "inference/engine.h"
+#include "inference/batch_scheduler.h"
+#include "llm/sampler.h"
 #include "translation/data_structures.h"
 #include "utils/config.h"
+#include "utils/sharded_lru_cache.h"
 #include <sentencepiece_processor.h>
 #include <gtest/gtest.h>
 
@@ -23,6 +30,7 @@ namespace llm {
 namespace testing {
 class LLMModelTest;
 class NLLBModelTest;
+class NLLBOneHotModelTest;
 }
 
 /**
@@ -35,9 +43,15 @@ struct LLMConfig {
     int maxLength = 1024;              ///< Maximum generation length
     int beamSize = 4;                  ///< Beam search size
     int numThreads = 4;                ///< Number of threads for inference
+    int maxBatchSize = 8;              ///< Maximum sequences decoded together
     float topP = 0.9f;                 ///< Top-p sampling threshold
     int topK = 40;                     ///< Top-k sampling threshold
     float repeatPenalty = 1.1f;        ///< Penalty for repeated tokens
+    int repeatWindow = 64;             ///< Recent tokens the repeat penalty looks at, 0 for all
+    int64_t seed = -1;                 ///< Sampling seed, -1 picks a fresh seed per request
+    size_t tokenCacheSize = 4096;      ///< Tokenized texts kept for reuse, 0 disables the cache
+    int draftTokens = 4;               ///< Tokens a draft model proposes per decode step
+    bool useShortlist = true;          ///< Restrict output to the target language's shortlist if the model has one
     bool useGPU = false;              ///< Whether to use GPU acceleration
     std::string deviceType = "cpu";   ///< Device type (cpu, metal, vulkan, cuda)
 };
@@ -50,7 +64,9 @@ struct LLMOutput {
     std::string text;                  ///< Generated text
     bool success = false;              ///< Whether generation was successful
     std::string errorMessage;          ///< Error message if generation failed
+    bool partial = false;              ///< Cancelled or timed out, text holds what was generated
     translation::InferenceStats stats; ///< Generation statistics
+    uint64_t seed = 0;                 ///< Sampling seed, reproduces the output when set in LLMConfig
 };
 
 /**
@@ -60,10 +76,11 @@ struct LLMOutput {
  * This class extends the GGMLModel to provide specific LLM functionality
  * including text completion, chat, and other LLM-specific operations.
  */
-class LLMModel : public models::GGMLModel {
+class LLMModel : public models::GGMLModel, public std::enable_shared_from_this<LLMModel> {
 public:
     friend class koebridge::llm::testing::LLMModelTest;
     friend class koebridge::llm::testing::NLLBModelTest;
+    friend class koebridge::llm::testing::NLLBOneHotModelTest;
 
     /**
      * @brief Constructor for LLMModel
@@ -92,11 +109,42 @@ public:
 
     /**
      * @brief Generate text completion asynchronously
+     *
+     * A pool thread tokenizes the prompt and another one detokenizes the result; no
+     * thread waits while the scheduler decodes. A model owned by a shared_ptr keeps
+     * itself alive until the completion is done.
+     *
      * @param prompt The input prompt to complete
      * @return std::future<LLMOutput> Future containing the generated completion
      */
     std::future<LLMOutput> completeAsync(const std::string& prompt);
 
+    /**
+     * @brief Generate text completion, reporting the text as it is generated
+     *
+     * The callback runs on the decoding thread after every token that completes
+     * some text. Unlike complete(), the returned text holds only the generated part.
+     *
+     * @param prompt The input prompt to complete
+     * @param callback Receives each newly decoded piece of text, returns false to stop
+     * @return LLMOutput The generated text and metadata
+     */
+    LLMOutput completeStream(const std::string& prompt, const translation::TranslationStreamCallback& callback);
+
+    /**
+     * @brief Translate text through the batch scheduler, reporting the output as it is decoded
+     *
+     * The text is prompted and sampled like complete(), with the model's shortlist and
+     * encoder, and the options' cancellation token stops the sequence early.
+     *
+     * @param text The input text to translate
+     * @param options Translation options and parameters
+     * @param callback Receives each newly decoded piece of text, returns false to stop
+     * @return TranslationResult The translation result
+     */
+    translation::TranslationResult translateStream(const std::string& text, const translation::TranslationOptions& options,
+                                                   const translation::TranslationStreamCallback& callback) override;
+
     /**
      * @brief Set configuration options for the LLM
      * @param config New configuration options
@@ -118,10 +166,14 @@ public:
 
     /**
      * @brief Convert text to token IDs using the local tokenizer
+     *
+     * Short texts are looked up in a bounded LRU cache keyed by their normalized form
+     * first, so repeated phrases skip the tokenizer.
+     *
      * @param text Input text to tokenize
      * @return std::vector<int> Vector of token IDs
      */
-    virtual std::vector<int> localTokenize(const std::string& text);
+    std::vector<int> localTokenize(const std::string& text);
 
     /**
      * @brief Convert token IDs back to text using the local tokenizer
@@ -130,18 +182,176 @@ public:
      */
     virtual std::string localDetokenize(const std::vector<int>& tokens);
 
+    /**
+     * @brief Pair the model with a smaller draft model for speculative decoding
+     *
+     * Each decode step the draft proposes config.draftTokens tokens greedily and this
+     * model checks them in the same batched forward pass as its own next token. The
+     * output is unchanged, only produced in fewer steps when the draft agrees.
+     *
+     * @param draft Initialized draft model sharing this model's vocabulary, nullptr to remove
+     * @return bool True if the draft was set or removed
+     */
+    bool setDraftModel(std::shared_ptr<LLMModel> draft);
+
+    /**
+     * @brief Get the draft model used for speculative decoding
+     * @return std::shared_ptr<LLMModel> The draft model, nullptr if none is set
+     */
+    std::shared_ptr<LLMModel> getDraftModel() const;
+
+    /**
+     * @brief Propose the tokens most likely to follow several histories, as a draft model
+     *
+     * All histories are decoded greedily as one batch.
+     *
+     * @param histories Tokens generated so far, one list per sequence
+     * @param maxTokens Maximum number of tokens to propose per sequence
+     * @return std::vector<std::vector<int>> Proposed tokens per sequence
+     */
+    std::vector<std::vector<int>> proposeTokens(const std::vector<const std::vector<int>*>& histories,
+                                                const std::vector<int>& maxTokens);
+
+    /**
+     * @brief Get the tokenization cache counters
+     * @return utils::CacheStats Hits, misses and size of the cache
+     */
+    utils::CacheStats getTokenCacheStats() const;
+
 protected:
+    /**
+     * @brief Tokenize text with the SentencePiece model, bypassing the cache
+     * @param text Input text to tokenize
+     * @return std::vector<int> Vector of token IDs, only BOS if no tokenizer is loaded
+     */
+    virtual std::vector<int> encodeText(const std::string& text);
+
+    /**
+     * @brief Tokenize a prompt for runGeneration()
+     * @param prompt Formatted prompt
+     * @return std::vector<int> Vector of token IDs
+     */
+    virtual std::vector<int> tokenizePrompt(const std::string& prompt);
+
+    /**
+     * @brief Tokenize text through the tokenization cache
+     *
+     * The text is encoded with its whitespace normalized, cached or not. Models whose
+     * token IDs depend on more than the text pass that state as the key prefix, so every
+     * variant gets its own entry.
+     *
+     * @param text Input text to tokenize
+     * @param keyPrefix Prepended to the normalized text to form the cache key
+     * @param encode Tokenizes text on a miss
+     * @return std::vector<int> Vector of token IDs
+     */
+    std::vector<int> tokenizeCached(const std::string& text, const std::string& keyPrefix,
+                                    const std::function<std::vector<int>(const std::string&)>& encode);
+
+    /**
+     * @brief Get the output tokens generation is restricted to
+     * @param promptTokens Tokenized prompt
+     * @return std::shared_ptr<const std::vector<int>> Sorted token IDs, nullptr for the full vocabulary
+     */
+    virtual std::shared_ptr<const std::vector<int>> outputShortlist(const std::vector<int>& promptTokens);
+
+    /**
+     * @brief Run the encoder over the source part of a prompt
+     * @param promptTokens Tokenized prompt
+     * @return std::shared_ptr<const inference::EncoderOutput> Encoder states, nullptr for decoder-only models
+     */
+    virtual std::shared_ptr<const inference::EncoderOutput> encodeSource(const std::vector<int>& promptTokens);
+
     /**
      * @brief Apply the given prompt to the model
      * @param prompt The input prompt
      * @param output Vector to store the generated tokens
      * @param stats Statistics about the generation
+     * @param seed Seed of the request's sampler
+     * @param onToken Optional callback receiving each generated token
+     * @return bool True if generation was successful
+     */
+    bool runGeneration(const std::string& prompt, std::vector<int>& output, translation::InferenceStats& stats,
+                       uint64_t seed, const inference::TokenCallback& onToken = nullptr);
+
+    /**
+     * @brief Take the tokens and statistics of a finished generation
+     * @param result Finished sequence
+     * @param contextSize Number of prompt tokens the sequence started from
+     * @param startTime Time the generation started
+     * @param output Vector to store the generated tokens
+     * @param stats Statistics about the generation
      * @return bool True if generation was successful
      */
-    bool runGeneration(const std::string& prompt, std::vector<int>& output, translation::InferenceStats& stats);
+    bool collectGeneration(inference::SequenceResult result, size_t contextSize,
+                           std::chrono::high_resolution_clock::time_point startTime,
+                           std::vector<int>& output, translation::InferenceStats& stats);
+
+    /**
+     * @brief Build a scheduler request with this model's sampling settings and draft
+     * @param promptTokens Tokenized prompt, truncated to the context window
+     * @param seed Seed of the request's sampler
+     * @param onToken Optional callback receiving each generated token
+     * @return inference::SequenceRequest Request without shortlist or encoder output
+     */
+    inference::SequenceRequest buildRequest(std::vector<int> promptTokens, uint64_t seed,
+                                            const inference::TokenCallback& onToken = nullptr);
+
+    /**
+     * @brief Build a scheduler request for a prompt, with the model's shortlist and encoder output
+     * @param promptTokens Tokenized prompt
+     * @param seed Seed of the request's sampler
+     * @param onToken Optional callback receiving each generated token
+     * @return inference::SequenceRequest Request ready for submitRequest()
+     */
+    inference::SequenceRequest buildPromptRequest(std::vector<int> promptTokens, uint64_t seed,
+                                                  const inference::TokenCallback& onToken = nullptr);
+
+    /**
+     * @brief Submit a request to the model's batch scheduler
+     *
+     * Requests submitted back to back are decoded in the same batch.
+     *
+     * @param request The request
+     * @return std::future<inference::SequenceResult> Future completed when the sequence finishes
+     */
+    std::future<inference::SequenceResult> submitRequest(inference::SequenceRequest request);
+
+    /**
+     * @brief Submit several requests to the model's batch scheduler in one go
+     * @param requests The requests, admitted to the same decode step
+     * @return std::vector<std::future<inference::SequenceResult>> One future per request, in order
+     */
+    std::vector<std::future<inference::SequenceResult>> submitRequests(
+        std::vector<inference::SequenceRequest> requests);
+
+    /**
+     * @brief Submit a request without a thread waiting for it
+     *
+     * The scheduler hands the finished sequence to the shared pool, which runs onResult.
+     * The model is kept until onResult has returned.
+     *
+     * @param request The request
+     * @param onResult Receives the finished sequence on a pool thread
+     */
+    void submitDetached(inference::SequenceRequest request,
+                        std::function<void(inference::SequenceResult)> onResult);
+
+    /**
+     * @brief Copy the speculative decoding counters of a sequence into stats
+     * @param result Finished sequence
+     * @param stats Statistics to update
+     */
+    static void recordDraftStats(const inference::SequenceResult& result, translation::InferenceStats& stats);
 
 private:
     LLMConfig config_;                  ///< Configuration options
+    std::unique_ptr<inference::BatchScheduler> scheduler_; ///< Continuous batching scheduler, started by the first request
+    std::once_flag schedulerStarted_;   ///< Guards the creation of scheduler_
+    utils::ShardedLruCache<std::string, std::vector<int>> tokenCache_; ///< Token IDs of recent short texts
+    std::shared_ptr<LLMModel> draft_;   ///< Draft model for speculative decoding
+    std::shared_ptr<const inference::DraftProposer> draftProposer_; ///< Proposes with draft_, shared by its requests
+    mutable std::mutex draftMutex_;     ///< Guards draft_ and draftProposer_
 };
 
 } // namespace llm
@@ -4,28 +4,59 @@
  */
 
 #include "llm/nllb_model.h"
+#include "inference/incremental_decoder.h"
 #include "utils/config.h"
 #include "utils/logger.h"
+#include "utils/random.h"
+#include <atomic>
 #include <iostream>
 #include <future>
 #include <algorithm>
+#include <chrono>
 
 namespace koebridge {
 namespace llm {
 
+namespace {
+
+constexpr int kEosToken = 2;
+
+// The decoder starts from EOS followed by the target language token, so the last
+// prompt token, the one the scheduler feeds first, selects the output language
+void appendDecoderPrefix(std::vector<int>& tokens, int targetToken) {
+    tokens.push_back(kEosToken);
+    tokens.push_back(targetToken);
+}
+
+translation::TranslationResult toTranslationResult(const std::string& text, LLMOutput output) {
+    translation::TranslationResult result;
+    result.sourceText = text;
+    result.text = std::move(output.text);
+    result.success = output.success;
+    result.errorMessage = std::move(output.errorMessage);
+    result.partial = output.partial;
+    result.metrics.totalTimeMs = output.stats.totalTimeMs;
+    result.metrics.inferenceTimeMs = output.stats.inferenceTimeMs;
+    result.metrics.inputTokenCount = output.stats.inputTokenCount;
+    result.metrics.outputTokenCount = output.stats.outputTokenCount;
+    return result;
+}
+
+} // namespace
+
 NLLBModel::NLLBModel(
     const translation::ModelInfo& modelInfo,
     const std::string& sourceLanguage,
     const std::string& targetLanguage,
     const LLMConfig& config
 ) : LLMModel(modelInfo, config),
-    sourceLanguage_(sourceLanguage),
-    targetLanguage_(targetLanguage) {
-    // Additional initialization will be done in initialize()
+    languages_(std::make_shared<const LanguagePair>(LanguagePair{sourceLanguage, targetLanguage})) {
+    languageTokens_.fill(-1);
 }
 
 NLLBModel::~NLLBModel() {
-    // Cleanup will be handled by the base class
+    // Pending calls dispatch to this class, let them finish before it is torn down
+    waitForAsyncCalls();
 }
 
 bool NLLBModel::initialize() {
@@ -36,85 +67,356 @@ bool NLLBModel::initialize() {
     }
 
     // Initialize language-specific tokens
-    initializeLanguageTokens();
+    if (!initializeLanguageTokens()) {
+        return false;
+    }
 
-    std::cout << "NLLB model initialized for " << sourceLanguage_ << " -> " << targetLanguage_ << std::endl;
+    const LanguagePair languages = getLanguagePair();
+    std::cout << "NLLB model initialized for " << languages.source << " -> " << languages.target << std::endl;
     return true;
 }
 
 LLMOutput NLLBModel::translate(const std::string& text) {
-    // Use the complete method from the parent class
-    return complete(text);
+    return translate(text, getLanguagePair());
+}
+
+LLMOutput NLLBModel::translate(const std::string& text, const LanguagePair& languages,
+                               std::shared_ptr<const utils::CancellationToken> cancellation,
+                               const inference::TokenCallback& onToken) {
+    LLMOutput output;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    inference::SequenceRequest request;
+    if (prepareTranslation(text, languages, std::move(cancellation), onToken, output, request)) {
+        collectTranslation(submitRequest(std::move(request)).get(), output, startTime);
+    }
+    return output;
+}
+
+translation::TranslationResult NLLBModel::translate(const std::string& text,
+                                                    const translation::TranslationOptions& options) {
+    return toTranslationResult(text, translate(text, languagesFor(options), options.cancellation));
+}
+
+std::future<translation::TranslationResult> NLLBModel::translateAsync(
+    const std::string& text, const translation::TranslationOptions& options) {
+    auto promise = std::make_shared<std::promise<translation::TranslationResult>>();
+    std::future<translation::TranslationResult> future = promise->get_future();
+
+    // Pool threads only tokenize and detokenize, no thread waits while the scheduler decodes
+    runAsync([this, self = weak_from_this().lock(), text, options, promise]() {
+        LLMOutput output;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        inference::SequenceRequest request;
+        if (!prepareTranslation(text, languagesFor(options), options.cancellation, nullptr, output, request)) {
+            promise->set_value(toTranslationResult(text, std::move(output)));
+            return;
+        }
+        submitDetached(std::move(request), [this, text, output, startTime, promise](
+                                               inference::SequenceResult result) mutable {
+            collectTranslation(std::move(result), output, startTime);
+            promise->set_value(toTranslationResult(text, std::move(output)));
+        });
+    });
+    return future;
+}
+
+bool NLLBModel::prepareTranslation(const std::string& text, const LanguagePair& languages,
+                                   std::shared_ptr<const utils::CancellationToken> cancellation,
+                                   const inference::TokenCallback& onToken, LLMOutput& output,
+                                   inference::SequenceRequest& request) {
+    if (!isInitialized()) {
+        output.errorMessage = "Model not initialized";
+        return false;
+    }
+    // Skip the encoder too if the request expired while it was queued
+    if (cancellation && cancellation->shouldStop()) {
+        output.partial = true;
+        output.errorMessage = cancellation->stopReason();
+        return false;
+    }
+
+    const int sourceLanguage = languageIndex(languages.source);
+    const int targetLanguage = languageIndex(languages.target);
+    if (sourceLanguage < 0 || targetLanguage < 0) {
+        LOG_WARNING("Unsupported language pair: " + languages.source + " -> " + languages.target);
+    }
+
+    try {
+        const std::vector<int> sourceTokens = tokenizeSource(text, sourceLanguage);
+        request = buildTranslation(sourceTokens, engine_->encode(sourceTokens), targetLanguage, output,
+                                   std::move(cancellation), onToken);
+        return true;
+    } catch (const std::exception& e) {
+        output.success = false;
+        output.errorMessage = std::string("Error during generation: ") + e.what();
+        return false;
+    }
+}
+
+translation::TranslationResult NLLBModel::translateStream(const std::string& text,
+                                                          const translation::TranslationOptions& options,
+                                                          const translation::TranslationStreamCallback& callback) {
+    // Tokens arrive on the scheduler thread and are decoded to text one at a time
+    inference::IncrementalDecoder decoder(*engine_);
+    auto onToken = [&decoder, &callback](int token) {
+        if (token == kEosToken) {
+            return true;
+        }
+        std::string piece = decoder.push(token);
+        return piece.empty() || !callback || callback(piece);
+    };
+
+    LLMOutput output = translate(text, languagesFor(options), options.cancellation, onToken);
+    if (output.success || output.partial) {
+        std::string rest = decoder.flush();
+        if (!rest.empty() && callback) {
+            callback(rest);
+        }
+        output.text = decoder.getText();
+    }
+    return toTranslationResult(text, std::move(output));
+}
+
+LanguagePair NLLBModel::languagesFor(const translation::TranslationOptions& options) const {
+    LanguagePair languages = getLanguagePair();
+    if (!options.sourceLanguage.empty()) {
+        languages.source = options.sourceLanguage;
+    }
+    if (!options.targetLanguage.empty()) {
+        languages.target = options.targetLanguage;
+    }
+    return languages;
 }
 
 void NLLBModel::setSourceLanguage(const std::string& language) {
-    sourceLanguage_ = language;
-    // Re-initialize language tokens when language changes
-    initializeLanguageTokens();
+    updateLanguagePair([&language](LanguagePair& languages) {
+        languages.source = language;
+    });
 }
 
 void NLLBModel::setTargetLanguage(const std::string& language) {
-    targetLanguage_ = language;
-    // Re-initialize language tokens when language changes
-    initializeLanguageTokens();
+    updateLanguagePair([&language](LanguagePair& languages) {
+        languages.target = language;
+    });
 }
 
 std::string NLLBModel::getSourceLanguage() const {
-    return sourceLanguage_;
+    return getLanguagePair().source;
 }
 
 std::string NLLBModel::getTargetLanguage() const {
-    return targetLanguage_;
+    return getLanguagePair().target;
+}
+
+LanguagePair NLLBModel::getLanguagePair() const {
+    return *std::atomic_load(&languages_);
+}
+
+void NLLBModel::updateLanguagePair(const std::function<void(LanguagePair&)>& update) {
+    // Readers never lock: they keep whichever pair they loaded, and concurrent
+    // setters retry until their copy replaced the pair it was made from
+    std::shared_ptr<const LanguagePair> current = std::atomic_load(&languages_);
+    std::shared_ptr<const LanguagePair> next;
+    do {
+        auto copy = std::make_shared<LanguagePair>(*current);
+        update(*copy);
+        next = std::move(copy);
+    } while (!std::atomic_compare_exchange_weak(&languages_, &current, next));
 }
 
 std::string NLLBModel::formatPrompt(const std::string& prompt) {
-    // Get source and target language tokens
-    auto sourceToken = specialTokens_.find("__" + sourceLanguage_ + "__");
-    auto targetToken = specialTokens_.find("__" + targetLanguage_ + "__");
+    return prompt;
+}
 
-    if (sourceToken == specialTokens_.end() || targetToken == specialTokens_.end()) {
-        std::cerr << "Unsupported language pair: " << sourceLanguage_ << " -> " << targetLanguage_ << std::endl;
-        return prompt;
+std::vector<int> NLLBModel::tokenizePrompt(const std::string& prompt) {
+    return tokenizeForPair(prompt, getLanguagePair());
+}
+
+std::shared_ptr<const std::vector<int>> NLLBModel::outputShortlist(const std::vector<int>& promptTokens) {
+    const int targetLanguage = targetLanguageOf(promptTokens);
+    if (targetLanguage < 0) {
+        return nullptr;
     }
+    return engine_->getShortlist(std::string(kLanguageCodes[targetLanguage]), promptTokens);
+}
 
-    // Format: <source_lang> text <target_lang>
-    return std::to_string(sourceToken->second) + " " + prompt + " " + std::to_string(targetToken->second);
+std::shared_ptr<const inference::EncoderOutput> NLLBModel::encodeSource(const std::vector<int>& promptTokens) {
+    std::vector<int> sourceTokens = promptTokens;
+
+    // Drop the decoder prefix that tokenizeForPair() appends
+    if (targetLanguageOf(sourceTokens) >= 0) {
+        sourceTokens.resize(sourceTokens.size() - 2);
+    }
+    return engine_->encode(sourceTokens);
 }
 
-std::vector<int> NLLBModel::localTokenize(const std::string& text) {
-    std::vector<int> tokens;
+std::vector<int> NLLBModel::tokenizeSource(const std::string& text, int sourceLanguage) {
+    // The source side depends on the source language only, so every target shares the entry
+    const std::string keyPrefix = sourceLanguage >= 0
+        ? std::string(kLanguageCodes[sourceLanguage]) + '\x1f'
+        : std::string("\x1f");
 
-    // Add BOS token
-    tokens.push_back(1);  // BOS token ID
+    return tokenizeCached(text, keyPrefix, [this, sourceLanguage](const std::string& uncached) {
+        std::vector<int> tokens;
+
+        // Add BOS token
+        tokens.push_back(1);  // BOS token ID
+
+        // Get the tokenizer from the engine
+        auto* tokenizer = static_cast<sentencepiece::SentencePieceProcessor*>(engine_->getTokenizer());
+        if (!tokenizer) {
+            std::cerr << "Tokenizer not available" << std::endl;
+            return tokens;
+        }
+
+        // Add source language token
+        if (sourceLanguage >= 0 && languageTokens_[sourceLanguage] >= 0) {
+            tokens.push_back(languageTokens_[sourceLanguage]);
+        }
+
+        // Tokenize the text
+        std::vector<int> textTokens;
+        tokenizer->Encode(uncached, &textTokens);
+        tokens.insert(tokens.end(), textTokens.begin(), textTokens.end());
+
+        // Add EOS token
+        tokens.push_back(kEosToken);
 
-    // Get the tokenizer from the engine
-    auto* tokenizer = static_cast<sentencepiece::SentencePieceProcessor*>(engine_->getTokenizer());
-    if (!tokenizer) {
-        std::cerr << "Tokenizer not available" << std::endl;
         return tokens;
+    });
+}
+
+std::vector<int> NLLBModel::tokenizeForPair(const std::string& text, const LanguagePair& languages) {
+    std::vector<int> tokens = tokenizeSource(text, languageIndex(languages.source));
+
+    // Follow the source with the decoder prefix of the target language
+    const int targetToken = languageTokenId(languages.target);
+    if (targetToken >= 0) {
+        appendDecoderPrefix(tokens, targetToken);
     }
+    return tokens;
+}
+
+int NLLBModel::languageTokenId(const std::string& language) const {
+    const int index = languageIndex(language);
+    return index >= 0 ? languageTokens_[index] : -1;
+}
 
-    // Add source language token
-    auto sourceIt = specialTokens_.find(sourceLanguage_);
-    if (sourceIt != specialTokens_.end()) {
-        tokens.push_back(sourceIt->second);
+int NLLBModel::targetLanguageOf(const std::vector<int>& promptTokens) const {
+    if (promptTokens.size() < 3 || promptTokens[promptTokens.size() - 2] != kEosToken) {
+        return -1;
     }
+    // The source language token sits right after BOS, the target token right after the last EOS
+    const int token = promptTokens.back();
+    auto it = std::find(languageTokens_.begin(), languageTokens_.end(), token);
+    return it != languageTokens_.end() ? static_cast<int>(it - languageTokens_.begin()) : -1;
+}
 
-    // Tokenize the text
-    std::vector<int> textTokens;
-    tokenizer->Encode(text, &textTokens);
-    tokens.insert(tokens.end(), textTokens.begin(), textTokens.end());
+std::map<std::string, LLMOutput> NLLBModel::translateMulti(const std::string& text, const std::string& sourceLanguage,
+                                                           const std::vector<std::string>& targetLanguages,
+                                                           std::shared_ptr<const utils::CancellationToken> cancellation) {
+    std::map<std::string, LLMOutput> outputs;
+    if (!isInitialized()) {
+        for (const auto& language : targetLanguages) {
+            outputs[language].errorMessage = "Model not initialized";
+        }
+        return outputs;
+    }
+    // Skip the encoder too if the request expired while it was queued
+    if (cancellation && cancellation->shouldStop()) {
+        for (const auto& language : targetLanguages) {
+            outputs[language].partial = true;
+            outputs[language].errorMessage = cancellation->stopReason();
+        }
+        return outputs;
+    }
 
-    // Add target language token
-    auto targetIt = specialTokens_.find(targetLanguage_);
-    if (targetIt != specialTokens_.end()) {
-        tokens.push_back(targetIt->second);
+    const int sourceIndex = languageIndex(sourceLanguage);
+    if (sourceIndex < 0) {
+        LOG_WARNING("Unsupported source language: " + sourceLanguage);
     }
 
-    // Add EOS token
-    tokens.push_back(2);  // EOS token ID
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-    return tokens;
+    // Encode once: the encoder input has no target language token
+    const std::vector<int> sourceTokens = tokenizeSource(text, sourceIndex);
+    std::shared_ptr<const inference::EncoderOutput> encoderOutput = engine_->encode(sourceTokens);
+
+    // Submit every target at once so the scheduler admits them to the same decode step
+    std::vector<std::string> submitted;
+    std::vector<inference::SequenceRequest> requests;
+    for (const auto& language : targetLanguages) {
+        if (outputs.count(language)) {
+            continue;
+        }
+        LLMOutput& output = outputs[language];
+
+        const int targetLanguage = languageIndex(language);
+        if (targetLanguage < 0 || languageTokens_[targetLanguage] < 0) {
+            output.errorMessage = "Unsupported target language: " + language;
+            continue;
+        }
+        submitted.push_back(language);
+        requests.push_back(buildTranslation(sourceTokens, encoderOutput, targetLanguage, output, cancellation));
+    }
+
+    std::vector<std::future<inference::SequenceResult>> pending = submitRequests(std::move(requests));
+    for (size_t i = 0; i < pending.size(); ++i) {
+        collectTranslation(pending[i].get(), outputs[submitted[i]], startTime);
+    }
+
+    return outputs;
+}
+
+inference::SequenceRequest NLLBModel::buildTranslation(
+    const std::vector<int>& sourceTokens,
+    const std::shared_ptr<const inference::EncoderOutput>& encoderOutput,
+    int targetLanguage, LLMOutput& output,
+    std::shared_ptr<const utils::CancellationToken> cancellation,
+    const inference::TokenCallback& onToken) {
+    const LLMConfig config = getConfig();
+
+    std::vector<int> promptTokens = sourceTokens;
+    const int targetToken = targetLanguage >= 0 ? languageTokens_[targetLanguage] : -1;
+    if (targetToken >= 0) {
+        appendDecoderPrefix(promptTokens, targetToken);
+    }
+    output.stats.inputTokenCount = promptTokens.size();
+
+    output.seed = config.seed >= 0 ? static_cast<uint64_t>(config.seed) : utils::Xoshiro256::randomSeed();
+    inference::SequenceRequest request = buildRequest(std::move(promptTokens), output.seed, onToken);
+    if (config.useShortlist && targetToken >= 0) {
+        request.shortlist = engine_->getShortlist(std::string(kLanguageCodes[targetLanguage]), sourceTokens);
+    }
+    request.encoderOutput = encoderOutput;
+    request.cancellation = std::move(cancellation);
+    return request;
+}
+
+void NLLBModel::collectTranslation(inference::SequenceResult result, LLMOutput& output,
+                                   std::chrono::high_resolution_clock::time_point startTime) {
+    if (!result.success && !result.interrupted) {
+        output.errorMessage = "Generation failed: " + result.errorMessage;
+        return;
+    }
+
+    // Only the generated part is text; the engine drops EOS and other special tokens
+    const size_t promptSize = std::min(result.tokens.size(), static_cast<size_t>(output.stats.inputTokenCount));
+    std::vector<int> generated(result.tokens.begin() + promptSize, result.tokens.end());
+    try {
+        output.text = engine_->detokenize(generated);
+    } catch (const std::exception& e) {
+        output.errorMessage = std::string("Error during generation: ") + e.what();
+        return;
+    }
+    output.success = result.success;
+    output.partial = result.interrupted;
+    output.errorMessage = result.errorMessage;
+    output.stats.outputTokenCount = generated.size();
+    output.stats.inferenceTimeMs = result.decodeTimeMs;
+    output.stats.totalTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    recordDraftStats(result, output.stats);
 }
 
 std::string NLLBModel::localDetokenize(const std::vector<int>& tokens) {
@@ -127,8 +429,8 @@ std::string NLLBModel::localDetokenize(const std::vector<int>& tokens) {
 
     // Remove special tokens (BOS, EOS, and language tokens)
     std::vector<int> textTokens;
-    if (tokens.size() > 4) {  // BOS + src_lang + text + tgt_lang + EOS
-        textTokens.assign(tokens.begin() + 2, tokens.end() - 2);
+    if (tokens.size() > 5) {  // BOS + src_lang + text + EOS + EOS + tgt_lang
+        textTokens.assign(tokens.begin() + 2, tokens.end() - 3);
     }
 
     // Detokenize
@@ -137,21 +439,32 @@ std::string NLLBModel::localDetokenize(const std::vector<int>& tokens) {
     return text;
 }
 
-void NLLBModel::initializeLanguageTokens() {
-    // Initialize special tokens for NLLB model
-    specialTokens_ = {
-        {"__ja__", 250025},  // Japanese
-        {"__en__", 250004},  // English
-        {"__zh__", 250010},  // Chinese
-        {"__ko__", 250011},  // Korean
-        {"__fr__", 250005},  // French
-        {"__de__", 250006},  // German
-        {"__es__", 250007},  // Spanish
-        {"__it__", 250008},  // Italian
-        {"__pt__", 250009},  // Portuguese
-        {"__ru__", 250012}   // Russian
-    };
+bool NLLBModel::initializeLanguageTokens() {
+    languageTokens_.fill(-1);
+
+    // Text is tokenized with SentencePiece IDs and the language tokens are taken from the
+    // model vocabulary, so a vocabulary without them cannot be mapped onto the pieces
+    size_t resolved = 0;
+    for (size_t i = 0; i < kLanguageCount; ++i) {
+        const std::string code(kLanguageCodes[i]);
+        int token = engine_->tokenToId("__" + code + "__");
+        if (token < 0) {
+            token = engine_->tokenToId(code);
+        }
+        languageTokens_[i] = token;
+        resolved += token >= 0 ? 1 : 0;
+    }
+
+    if (resolved == 0) {
+        LOG_ERROR("NLLB vocabulary has no __xx__ language tokens, convert the model with its language tokens");
+        return false;
+    }
+    if (resolved < kLanguageCount) {
+        LOG_WARNING("NLLB vocabulary has tokens for " + std::to_string(resolved) + " of " +
+                    std::to_string(kLanguageCount) + " languages");
+    }
+    return true;
 }
 
 } // namespace llm
-} // namespace koebridge
\ No newline at end of file
+} // namespace koebridge
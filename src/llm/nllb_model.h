@@ -6,22 +6,41 @@
 #pragma once
 
 #include "llm_model.h"
+#include "llm/language_codes.h"
+#include <array>
 #include <string>
 #include <vector>
 #include <memory>
 #include <future>
-#include <unordered_map>
+#include <map>
+#include <chrono>
+#include <functional>
 
 namespace koebridge {
 namespace llm {
 
+/**
+ * @struct LanguagePair
+ * @brief Source and target language of a translation request
+ */
+struct LanguagePair {
+    std::string source;                ///< Source language code
+    std::string target;                ///< Target language code
+};
+
 /**
  * @class NLLBModel
  * @brief Implementation of the NLLB model for translation
+ *
+ * The language tokens of all NLLB languages are resolved once at initialization, and
+ * every request carries its own language pair, so one loaded model serves concurrent
+ * requests for different pairs. The pair set with setSourceLanguage() and
+ * setTargetLanguage() is only the default for requests that name none.
  */
 class NLLBModel : public LLMModel {
 public:
     friend class koebridge::llm::testing::NLLBModelTest;
+    friend class koebridge::llm::testing::NLLBOneHotModelTest;
 
     /**
      * @brief Constructor for NLLBModel
@@ -47,50 +66,116 @@ public:
     bool initialize() override;
 
     /**
-     * @brief Translate text from source to target language
+     * @brief Translate text using the default language pair
      * @param text Text to translate
      * @return LLMOutput The translation result
      */
     LLMOutput translate(const std::string& text);
 
     /**
-     * @brief Set the source language
+     * @brief Translate text between the given languages
+     *
+     * Unknown languages are translated without their language token, with a warning.
+     *
+     * @param text Text to translate
+     * @param languages Language pair of this request
+     * @param cancellation Stops decoding early, keeping the partial text (none if null)
+     * @param onToken Optional callback receiving each generated token on the scheduler thread
+     * @return LLMOutput The translation result
+     */
+    LLMOutput translate(const std::string& text, const LanguagePair& languages,
+                        std::shared_ptr<const utils::CancellationToken> cancellation = nullptr,
+                        const inference::TokenCallback& onToken = nullptr);
+
+    /**
+     * @brief Translate text with the language pair given in the options
+     * @param text Text to translate
+     * @param options Translation options, empty languages fall back to the default pair
+     * @return translation::TranslationResult The translation result
+     */
+    translation::TranslationResult translate(const std::string& text,
+                                             const translation::TranslationOptions& options) override;
+
+    /**
+     * @brief Translate text asynchronously with the language pair given in the options
+     *
+     * A pool thread tokenizes and encodes the source and another one detokenizes the
+     * output; no thread waits while the scheduler decodes.
+     *
+     * @param text Text to translate
+     * @param options Translation options, empty languages fall back to the default pair
+     * @return std::future<translation::TranslationResult> Future containing the translation result
+     */
+    std::future<translation::TranslationResult> translateAsync(
+        const std::string& text, const translation::TranslationOptions& options) override;
+
+    /**
+     * @brief Translate text with the options' language pair, reporting the output as it is decoded
+     * @param text Text to translate
+     * @param options Translation options, empty languages fall back to the default pair
+     * @param callback Receives each newly decoded piece of text, returns false to stop
+     * @return translation::TranslationResult The translation result
+     */
+    translation::TranslationResult translateStream(const std::string& text,
+                                                   const translation::TranslationOptions& options,
+                                                   const translation::TranslationStreamCallback& callback) override;
+
+    /**
+     * @brief Translate text into several target languages at once
+     *
+     * The source is tokenized and encoded once; one decoder sequence per target
+     * language is then submitted together, so they are decoded as one batch.
+     *
+     * @param text Text to translate
+     * @param sourceLanguage Source language code
+     * @param targetLanguages Target language codes
+     * @param cancellation Stops every target early, keeping the partial texts (none if null)
+     * @return std::map<std::string, LLMOutput> Translation per target language
+     */
+    std::map<std::string, LLMOutput> translateMulti(const std::string& text, const std::string& sourceLanguage,
+                                                    const std::vector<std::string>& targetLanguages,
+                                                    std::shared_ptr<const utils::CancellationToken> cancellation = nullptr);
+
+    /**
+     * @brief Set the default source language
      * @param language Language code
      */
     void setSourceLanguage(const std::string& language);
 
     /**
-     * @brief Set the target language
+     * @brief Set the default target language
      * @param language Language code
      */
     void setTargetLanguage(const std::string& language);
 
     /**
-     * @brief Get the source language
+     * @brief Get the default source language
      * @return std::string Source language code
      */
     std::string getSourceLanguage() const;
 
     /**
-     * @brief Get the target language
+     * @brief Get the default target language
      * @return std::string Target language code
      */
     std::string getTargetLanguage() const;
 
+    /**
+     * @brief Get the default language pair
+     * @return LanguagePair Consistent snapshot of both languages
+     */
+    LanguagePair getLanguagePair() const;
+
     /**
      * @brief Format the input prompt according to the model's requirements
+     *
+     * NLLB takes the plain text; the language tokens are added during tokenization.
+     *
      * @param prompt The input prompt to format
      * @return std::string The formatted prompt
      */
     std::string formatPrompt(const std::string& prompt) override;
 
-    /**
-     * @brief Convert text to token IDs using the local tokenizer
-     * @param text Input text to tokenize
-     * @return std::vector<int> Vector of token IDs
-     */
-    std::vector<int> localTokenize(const std::string& text) override;
-
     /**
      * @brief Convert token IDs back to text using the local tokenizer
      * @param tokens Vector of token IDs to detokenize
@@ -100,14 +185,127 @@ public:
 
 protected:
     /**
-     * @brief Initialize language-specific tokens
+     * @brief Tokenize a prompt for the default language pair
+     * @param prompt Formatted prompt
+     * @return std::vector<int> Vector of token IDs
+     */
+    std::vector<int> tokenizePrompt(const std::string& prompt) override;
+
+    /**
+     * @brief Restrict output to the target language's shortlist plus the source tokens
+     * @param promptTokens Tokenized prompt
+     * @return std::shared_ptr<const std::vector<int>> Sorted token IDs, nullptr if the model has no shortlist
+     */
+    std::shared_ptr<const std::vector<int>> outputShortlist(const std::vector<int>& promptTokens) override;
+
+    /**
+     * @brief Encode the source sentence, reusing cached states for repeated sources
+     *
+     * The target language token is not part of the encoder input, so the same source
+     * translated into another language hits the cache too.
+     *
+     * @param promptTokens Tokenized prompt
+     * @return std::shared_ptr<const inference::EncoderOutput> Encoder states
+     */
+    std::shared_ptr<const inference::EncoderOutput> encodeSource(const std::vector<int>& promptTokens) override;
+
+    /**
+     * @brief Resolve the token of every known language from the model vocabulary
+     *
+     * Language tokens are looked up by their __xx__ piece or bare code only; their IDs
+     * are never derived from the SentencePiece model, whose IDs the vocabulary may shift.
+     *
+     * @return bool True if the vocabulary has a token for at least one language
      */
-    void initializeLanguageTokens();
+    bool initializeLanguageTokens();
+
+    /**
+     * @brief Tokenize the source side of a prompt, through the tokenization cache
+     * @param text Input text to tokenize
+     * @param sourceLanguage Index of the source language, -1 to leave out its token
+     * @return std::vector<int> BOS, source language, text and EOS tokens
+     */
+    std::vector<int> tokenizeSource(const std::string& text, int sourceLanguage);
+
+    /**
+     * @brief Tokenize text for a language pair
+     * @param text Input text to tokenize
+     * @param languages Language pair, unknown languages are left out
+     * @return std::vector<int> BOS, source language, text and EOS tokens, then EOS and target language as decoder prefix
+     */
+    std::vector<int> tokenizeForPair(const std::string& text, const LanguagePair& languages);
+
+    /**
+     * @brief Look up the token of a language
+     * @param language Language code, with or without the __xx__ decoration
+     * @return int Token ID, -1 if the language is unknown
+     */
+    int languageTokenId(const std::string& language) const;
+
+    /**
+     * @brief Find the language whose token marks the target of a prompt
+     * @param promptTokens Tokenized prompt
+     * @return int Index of the target language, -1 if the prompt has none
+     */
+    int targetLanguageOf(const std::vector<int>& promptTokens) const;
 
 private:
-    std::string sourceLanguage_;                   ///< Source language code
-    std::string targetLanguage_;                   ///< Target language code
-    std::unordered_map<std::string, int> specialTokens_; ///< Special tokens for languages
+    /**
+     * @brief Tokenize and encode a source text and build its decoder sequence
+     * @param text Text to translate
+     * @param languages Language pair of this request
+     * @param cancellation Stops decoding early, keeping the partial text (none if null)
+     * @param onToken Optional callback receiving each generated token on the scheduler thread
+     * @param output Receives the seed and input token count, or the error if nothing is to be decoded
+     * @param request Receives the request to submit
+     * @return bool True if the request is to be submitted, false if output is already final
+     */
+    bool prepareTranslation(const std::string& text, const LanguagePair& languages,
+                            std::shared_ptr<const utils::CancellationToken> cancellation,
+                            const inference::TokenCallback& onToken, LLMOutput& output,
+                            inference::SequenceRequest& request);
+
+    /**
+     * @brief Build the decoder sequence translating encoded source tokens into one language
+     * @param sourceTokens Source tokens without a target language token
+     * @param encoderOutput Encoder states of the source
+     * @param targetLanguage Index of the target language, -1 to leave out its token
+     * @param output Receives the seed and input token count
+     * @param cancellation Stops the sequence between decode steps (none if null)
+     * @param onToken Optional callback receiving each generated token
+     * @return inference::SequenceRequest Request ready for submitRequest()
+     */
+    inference::SequenceRequest buildTranslation(
+        const std::vector<int>& sourceTokens,
+        const std::shared_ptr<const inference::EncoderOutput>& encoderOutput,
+        int targetLanguage, LLMOutput& output,
+        std::shared_ptr<const utils::CancellationToken> cancellation = nullptr,
+        const inference::TokenCallback& onToken = nullptr);
+
+    /**
+     * @brief Fill in the text and statistics of a finished translation
+     * @param result Finished sequence of a buildTranslation() request
+     * @param output Output to complete
+     * @param startTime Time the request started
+     */
+    void collectTranslation(inference::SequenceResult result, LLMOutput& output,
+                            std::chrono::high_resolution_clock::time_point startTime);
+
+    /**
+     * @brief Get the language pair of a request
+     * @param options Translation options, empty languages fall back to the default pair
+     * @return LanguagePair The request's language pair
+     */
+    LanguagePair languagesFor(const translation::TranslationOptions& options) const;
+
+    /**
+     * @brief Replace the default language pair
+     * @param update Applied to a copy of the current pair
+     */
+    void updateLanguagePair(const std::function<void(LanguagePair&)>& update);
+
+    std::shared_ptr<const LanguagePair> languages_; ///< Default language pair, published atomically
+    std::array<int32_t, kLanguageCount> languageTokens_; ///< Token ID per kLanguageCodes entry, -1 if absent
 };
 
 } // namespace llm
@@ -0,0 +1,284 @@
+/**
+ * @file sampler.cc
+ * @brief Implementation of the token sampler
+ */
+
+#include "llm/sampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+namespace koebridge {
+namespace llm {
+
+namespace {
+
+// Independent accumulators per reduction; the fixed-width inner loops are what lets
+// the compiler keep them in vector registers without -ffast-math
+constexpr size_t kLanes = 8;
+
+// Bit pattern of -87.0f. For negative floats a larger pattern means a larger magnitude,
+// so clamping and the underflow test run as integer ops.
+constexpr uint32_t kExpMinBits = 0xC2AE0000u;
+
+// exp() for x <= 0, accurate to a few 1e-6 relative. Free of branches, float compares and
+// float-to-int conversions so the softmax loop vectorizes at -O3 without fast-math;
+// -inf and anything below -87 map to zero.
+inline float fastExp(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const uint32_t keep = bits < kExpMinBits ? 0xFFFFFFFFu : 0u;
+    bits = std::min(bits, kExpMinBits);
+    std::memcpy(&x, &bits, sizeof(x));
+
+    // n = round(x / ln2) via the 1.5 * 2^23 trick, the low mantissa bits then hold n
+    const float shifted = x * 1.44269504f + 12582912.0f;
+    const float n = shifted - 12582912.0f;
+    uint32_t nBits;
+    std::memcpy(&nBits, &shifted, sizeof(nBits));
+
+    // exp(x) = 2^n * exp(r) with |r| <= ln2 / 2
+    const float r = x - n * 0.693147181f;
+    const float p = 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6.0f + r * (1.0f / 24.0f +
+                    r * (1.0f / 120.0f + r * (1.0f / 720.0f + r * (1.0f / 5040.0f)))))));
+
+    const uint32_t scaleBits = ((nBits - 0x4B400000u + 127u) << 23) & keep;
+    float scale;
+    std::memcpy(&scale, &scaleBits, sizeof(scale));
+    return p * scale;
+}
+
+float maxValue(const float* values, size_t count) {
+    float lanes[kLanes];
+    std::fill(lanes, lanes + kLanes, -INFINITY);
+
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        for (size_t l = 0; l < kLanes; ++l) {
+            lanes[l] = std::max(lanes[l], values[i + l]);
+        }
+    }
+    for (; i < count; ++i) {
+        lanes[0] = std::max(lanes[0], values[i]);
+    }
+    return *std::max_element(lanes, lanes + kLanes);
+}
+
+// Fused softmax numerator: out[i] = exp((in[i] - maxLogit) * scale), returns the sum
+float expSum(const float* in, float* out, size_t count, float maxLogit, float scale) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = fastExp((in[i] - maxLogit) * scale);
+    }
+
+    float lanes[kLanes] = {};
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        for (size_t l = 0; l < kLanes; ++l) {
+            lanes[l] += out[i + l];
+        }
+    }
+    for (; i < count; ++i) {
+        lanes[0] += out[i];
+    }
+    return std::accumulate(lanes, lanes + kLanes, 0.0f);
+}
+
+bool byLogitDescending(const std::pair<float, int>& a, const std::pair<float, int>& b) {
+    return a.first > b.first;
+}
+
+} // namespace
+
+Sampler::Sampler(const SamplingParams& params)
+    : params_(params), rng_(params.seed) {
+    if (params_.repeatWindow > 0) {
+        windowCounts_.reserve(params_.repeatWindow);
+    }
+    if (params_.topK > 0) {
+        heap_.reserve(params_.topK);
+        candidateIds_.reserve(params_.topK);
+        candidateLogits_.reserve(params_.topK);
+        candidateProbs_.reserve(params_.topK);
+    }
+}
+
+int Sampler::sample(inference::LogitsSpan logits, const std::vector<int>& history) {
+    if (logits.empty()) {
+        return -1;
+    }
+
+    applyRepeatPenalty(logits, history);
+    selectCandidates(logits);
+    float sum = computeProbabilities();
+    sum = applyTopP(sum);
+    return draw(sum);
+}
+
+void Sampler::applyRepeatPenalty(inference::LogitsSpan logits, const std::vector<int>& history) {
+    if (params_.repeatPenalty <= 1.0f) {
+        return;
+    }
+
+    updateWindow(history);
+    for (const auto& entry : windowCounts_) {
+        const int token = entry.first;
+        if (token >= 0 && token < static_cast<int>(logits.size)) {
+            // Push the logit towards less likely whatever its sign
+            float& logit = logits[token];
+            logit = logit > 0.0f ? logit / params_.repeatPenalty : logit * params_.repeatPenalty;
+        }
+    }
+}
+
+void Sampler::updateWindow(const std::vector<int>& history) {
+    const size_t window = params_.repeatWindow > 0 ? params_.repeatWindow : history.size();
+
+    // Start over when the history did not grow from the counted one, or grew past
+    // the whole window (e.g. the prompt on the first step)
+    if (history.size() < windowEnd_ || history.size() - windowEnd_ >= window) {
+        windowCounts_.clear();
+        windowBegin_ = history.size() - std::min(window, history.size());
+        windowEnd_ = windowBegin_;
+    }
+
+    for (; windowEnd_ < history.size(); ++windowEnd_) {
+        ++windowCounts_[history[windowEnd_]];
+    }
+
+    for (; windowEnd_ - windowBegin_ > window; ++windowBegin_) {
+        auto it = windowCounts_.find(history[windowBegin_]);
+        if (--it->second == 0) {
+            windowCounts_.erase(it);
+        }
+    }
+}
+
+size_t Sampler::selectCandidates(inference::LogitsSpan logits) {
+    const size_t n = logits.size;
+
+    if (params_.topK > 0 && static_cast<size_t>(params_.topK) < n) {
+        selectTopK(logits, params_.topK);
+    } else if (params_.topP < 1.0f) {
+        selectNucleus(logits);
+    } else {
+        candidateIds_.resize(n);
+        std::iota(candidateIds_.begin(), candidateIds_.end(), 0);
+        candidateLogits_.assign(logits.begin(), logits.end());
+        return n;
+    }
+
+    candidateIds_.resize(heap_.size());
+    candidateLogits_.resize(heap_.size());
+    for (size_t i = 0; i < heap_.size(); ++i) {
+        candidateLogits_[i] = heap_[i].first;
+        candidateIds_[i] = heap_[i].second;
+    }
+    return candidateIds_.size();
+}
+
+void Sampler::selectTopK(inference::LogitsSpan logits, size_t k) {
+    // Min-heap of the K best logits; most entries only compare against its root
+    heap_.clear();
+    for (size_t i = 0; i < logits.size; ++i) {
+        const float logit = logits[i];
+        if (heap_.size() < k) {
+            heap_.emplace_back(logit, static_cast<int>(i));
+            std::push_heap(heap_.begin(), heap_.end(), byLogitDescending);
+        } else if (logit > heap_.front().first) {
+            std::pop_heap(heap_.begin(), heap_.end(), byLogitDescending);
+            heap_.back() = {logit, static_cast<int>(i)};
+            std::push_heap(heap_.begin(), heap_.end(), byLogitDescending);
+        }
+    }
+    std::sort_heap(heap_.begin(), heap_.end(), byLogitDescending);
+}
+
+void Sampler::selectNucleus(inference::LogitsSpan logits) {
+    const size_t n = logits.size;
+    const float scale = params_.temperature > 0 ? 1.0f / params_.temperature : 1.0f;
+    const float maxLogit = maxValue(logits.data, n);
+
+    // The nucleus is usually a tiny fraction of the vocabulary, so grow a top-k window
+    // until it holds the target mass instead of sorting everything
+    if (std::isfinite(maxLogit)) {
+        candidateProbs_.resize(n);
+        const float target = params_.topP * expSum(logits.data, candidateProbs_.data(), n, maxLogit, scale);
+
+        for (size_t k = kNucleusWindow; k < n; k *= 4) {
+            selectTopK(logits, k);
+            float mass = 0.0f;
+            for (const auto& entry : heap_) {
+                mass += candidateProbs_[entry.second];
+            }
+            if (mass >= target) {
+                return;
+            }
+        }
+    }
+
+    heap_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        heap_[i] = {logits[i], static_cast<int>(i)};
+    }
+    std::sort(heap_.begin(), heap_.end(), byLogitDescending);
+}
+
+float Sampler::computeProbabilities() {
+    const size_t n = candidateLogits_.size();
+    candidateProbs_.resize(n);
+
+    const float maxLogit = maxValue(candidateLogits_.data(), n);
+    if (!std::isfinite(maxLogit)) {
+        return 0.0f;
+    }
+
+    const float scale = params_.temperature > 0 ? 1.0f / params_.temperature : 1.0f;
+    return expSum(candidateLogits_.data(), candidateProbs_.data(), n, maxLogit, scale);
+}
+
+float Sampler::applyTopP(float sum) {
+    if (params_.topP >= 1.0f || sum <= 0.0f) {
+        return sum;
+    }
+
+    // Candidates are sorted, keep the shortest prefix that reaches the target mass
+    const float target = params_.topP * sum;
+    float cumulative = 0.0f;
+    size_t keep = 0;
+    while (keep < candidateProbs_.size()) {
+        cumulative += candidateProbs_[keep++];
+        if (cumulative >= target) {
+            break;
+        }
+    }
+
+    candidateIds_.resize(keep);
+    candidateLogits_.resize(keep);
+    candidateProbs_.resize(keep);
+    return cumulative;
+}
+
+int Sampler::draw(float sum) {
+    if (candidateIds_.empty()) {
+        return -1;
+    }
+    if (sum <= 0.0f) {
+        return candidateIds_.front();
+    }
+
+    const float r = rng_.nextFloat() * sum;
+    float cumsum = 0.0f;
+    for (size_t j = 0; j < candidateProbs_.size(); ++j) {
+        cumsum += candidateProbs_[j];
+        if (cumsum > r) {
+            return candidateIds_[j];
+        }
+    }
+
+    return candidateIds_.back();
+}
+
+} // namespace llm
+} // namespace koebridge
@@ -0,0 +1,143 @@
+/**
+ * @file sampler.h
+ * @brief Token sampling with logit processors that work in place on engine logits
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include "inference/engine.h"
+#include "utils/random.h"
+
+namespace koebridge {
+namespace llm {
+
+/**
+ * @struct SamplingParams
+ * @brief Parameters controlling how the next token is picked
+ */
+struct SamplingParams {
+    float temperature = 0.7f;          ///< Sampling temperature, <= 0 disables scaling
+    int topK = 40;                     ///< Keep only the K most likely tokens, <= 0 disables
+    float topP = 0.9f;                 ///< Nucleus probability mass, >= 1 disables
+    float repeatPenalty = 1.1f;        ///< Penalty for repeated tokens, <= 1 disables
+    int repeatWindow = 64;             ///< Recent tokens the penalty looks at, <= 0 for all
+    uint64_t seed = 0;                 ///< Seed of the sampler's random generator
+};
+
+/**
+ * @class Sampler
+ * @brief Picks the next token of a sequence from a row of logits
+ *
+ * Sampling runs as a pipeline over the engine's logits row: the repeat penalty is
+ * applied in place, top-k survivors are selected with a bounded heap, a fused
+ * max/exp/sum pass turns them into probabilities and top-p truncates the sorted
+ * survivors. All intermediate buffers and the random generator are owned by the
+ * sampler and reused across decode steps, so a sampler must not be shared between
+ * concurrent sequences. The same seed and logits always yield the same tokens.
+ */
+class Sampler {
+public:
+    /**
+     * @brief Constructor for Sampler
+     * @param params Sampling parameters
+     */
+    explicit Sampler(const SamplingParams& params);
+
+    /**
+     * @brief Run the whole pipeline and draw a token
+     * @param logits Logits of the current step, modified in place
+     * @param history Tokens of the sequence so far
+     * @return int The sampled token ID, -1 if the logits are empty
+     */
+    int sample(inference::LogitsSpan logits, const std::vector<int>& history);
+
+    /**
+     * @brief Penalize tokens that occur in the recent history, once per distinct token
+     *
+     * Occurrence counts of the window are updated incrementally from the tokens
+     * appended since the previous call, so a step costs O(new + distinct tokens).
+     *
+     * @param logits Logits to penalize in place
+     * @param history Tokens of the sequence so far
+     */
+    void applyRepeatPenalty(inference::LogitsSpan logits, const std::vector<int>& history);
+
+    /**
+     * @brief Select the candidate tokens, sorted by logit when top-k or top-p is active
+     * @param logits Logits of the current step
+     * @return size_t Number of candidates
+     */
+    size_t selectCandidates(inference::LogitsSpan logits);
+
+    /**
+     * @brief Turn the candidate logits into temperature-scaled probabilities
+     * @return float Sum of the unnormalized candidate probabilities
+     */
+    float computeProbabilities();
+
+    /**
+     * @brief Drop the candidates outside the top-p probability mass
+     * @param sum Sum of the unnormalized candidate probabilities
+     * @return float Probability mass of the remaining candidates
+     */
+    float applyTopP(float sum);
+
+    /**
+     * @brief Draw a token from the remaining candidates
+     * @param sum Probability mass of the remaining candidates
+     * @return int The sampled token ID
+     */
+    int draw(float sum);
+
+    /**
+     * @brief Get the current candidates
+     * @return const std::vector<int>& Candidate token IDs
+     */
+    const std::vector<int>& getCandidates() const { return candidateIds_; }
+
+    /**
+     * @brief Get the sampling parameters
+     * @return const SamplingParams& Current parameters
+     */
+    const SamplingParams& getParams() const { return params_; }
+
+private:
+    /**
+     * @brief Fill the heap with the K best logits, sorted descending
+     * @param logits Logits of the current step
+     * @param k Number of tokens to keep
+     */
+    void selectTopK(inference::LogitsSpan logits, size_t k);
+
+    /**
+     * @brief Fill the heap with a sorted prefix of the vocabulary covering the top-p mass
+     * @param logits Logits of the current step
+     */
+    void selectNucleus(inference::LogitsSpan logits);
+
+    /**
+     * @brief Bring the window counts up to date with the history
+     * @param history Tokens of the sequence so far
+     */
+    void updateWindow(const std::vector<int>& history);
+
+    /// First window tried when searching the nucleus without top-k
+    static constexpr size_t kNucleusWindow = 256;
+
+    SamplingParams params_;                     ///< Sampling parameters
+    utils::Xoshiro256 rng_;                     ///< Per-sequence random generator
+    std::unordered_map<int, int> windowCounts_; ///< Occurrences per token in the penalty window
+    size_t windowBegin_ = 0;                    ///< History index of the window's first token
+    size_t windowEnd_ = 0;                      ///< History length already counted
+    std::vector<std::pair<float, int>> heap_;   ///< Top-k selection heap
+    std::vector<int> candidateIds_;             ///< Candidate token IDs
+    std::vector<float> candidateLogits_;        ///< Logits of the candidates
+    std::vector<float> candidateProbs_;         ///< Unnormalized candidate probabilities
+};
+
+} // namespace llm
+} // namespace koebridge
@@ -1,4 +1,5 @@
 #include "models/ggml_model.h"
+#include "inference/incremental_decoder.h"
 #include "utils/config.h"
 #include "utils/logger.h"
 #include <iostream>
@@ -11,12 +12,14 @@ namespace models {
 GGMLModel::GGMLModel(const translation::ModelInfo& modelInfo)
     : modelInfo_(modelInfo),
       engine_(std::make_unique<inference::InferenceEngine>()),
+      threadPool_(utils::ThreadPool::shared()),
       initialized_(false) {
     LOG_INFO("Creating GGML model for: " + modelInfo.id);
 }
 
 GGMLModel::~GGMLModel() {
-    // Cleanup will be handled by smart pointers
+    // Cleanup will be handled by smart pointers once pending calls are done
+    waitForAsyncCalls();
 }
 
 bool GGMLModel::initialize() {
@@ -54,26 +57,82 @@ translation::TranslationResult GGMLModel::translate(const std::string& text, con
     try {
         auto startTime = std::chrono::high_resolution_clock::now();
 
-        // Process input through the inference engine
-        std::string output;
-        if (!engine_->processInput(text, output)) {
-            result.success = false;
-            result.errorMessage = "Translation failed";
-            return result;
+        // The request's cancellation token is checked after every decode step
+        bool interrupted = isStopped(options);
+        translation::InferenceStats stats;
+        std::vector<int> outputTokens;
+        if (!interrupted) {
+            std::vector<int> inputTokens = engine_->tokenize(text);
+            outputTokens = engine_->runInference(inputTokens, options, stats, stopOnCancel(options, interrupted));
         }
 
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
 
-        result.text = output;
+        result.text = engine_->detokenize(outputTokens);
         result.success = true;
         result.metrics.totalTimeMs = duration.count();
+        result.metrics.inferenceTimeMs = stats.inferenceTimeMs;
+        result.metrics.inputTokenCount = stats.inputTokenCount;
+        result.metrics.outputTokenCount = stats.outputTokenCount;
+        if (interrupted) {
+            markInterrupted(options, result);
+        }
+
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.errorMessage = std::string("Translation error: ") + e.what();
+    }
+
+    return result;
+}
+
+translation::TranslationResult GGMLModel::translateStream(
+    const std::string& text,
+    const translation::TranslationOptions& options,
+    const translation::TranslationStreamCallback& callback
+) {
+    translation::TranslationResult result;
+    result.sourceText = text;
+
+    if (!initialized_) {
+        result.success = false;
+        result.errorMessage = "Model not initialized";
+        return result;
+    }
 
-        // Get inference stats
+    try {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        // Each token is decoded on its own as soon as the engine produces it
+        inference::IncrementalDecoder decoder(*engine_);
         translation::InferenceStats stats;
-        engine_->runInference(std::vector<int>(), options, stats);
+        bool interrupted = isStopped(options);
+        if (!interrupted) {
+            std::vector<int> inputTokens = engine_->tokenize(text);
+            engine_->runInference(inputTokens, options, stats, stopOnCancel(options, interrupted, [&](int token) {
+                std::string piece = decoder.push(token);
+                return piece.empty() || !callback || callback(piece);
+            }));
+        }
+
+        std::string rest = decoder.flush();
+        if (!rest.empty() && callback) {
+            callback(rest);
+        }
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+
+        result.text = decoder.getText();
+        result.success = true;
+        result.metrics.totalTimeMs = duration.count();
         result.metrics.inferenceTimeMs = stats.inferenceTimeMs;
         result.metrics.inputTokenCount = stats.inputTokenCount;
+        result.metrics.outputTokenCount = stats.outputTokenCount;
+        if (interrupted) {
+            markInterrupted(options, result);
+        }
 
     } catch (const std::exception& e) {
         result.success = false;
@@ -87,15 +146,67 @@ std::future<translation::TranslationResult> GGMLModel::translateAsync(
     const std::string& text,
     const translation::TranslationOptions& options
 ) {
-    return std::async(std::launch::async, [this, text, options]() {
+    return runAsync([this, text, options]() {
         return translate(text, options);
     });
 }
 
+bool GGMLModel::isStopped(const translation::TranslationOptions& options) {
+    return options.cancellation && options.cancellation->shouldStop();
+}
+
+inference::TokenCallback GGMLModel::stopOnCancel(const translation::TranslationOptions& options, bool& interrupted,
+                                                 inference::TokenCallback onToken) {
+    std::shared_ptr<const utils::CancellationToken> cancellation = options.cancellation;
+    if (!cancellation) {
+        return onToken;
+    }
+    return [cancellation, &interrupted, onToken = std::move(onToken)](int token) {
+        if (onToken && !onToken(token)) {
+            return false;
+        }
+        if (cancellation->shouldStop()) {
+            interrupted = true;
+            return false;
+        }
+        return true;
+    };
+}
+
+void GGMLModel::markInterrupted(const translation::TranslationOptions& options,
+                                translation::TranslationResult& result) {
+    result.success = false;
+    result.partial = true;
+    result.errorMessage = options.cancellation ? options.cancellation->stopReason() : "Cancelled";
+}
+
+void GGMLModel::waitForAsyncCalls() {
+    std::unique_lock<std::mutex> lock(asyncMutex_);
+    asyncCv_.wait(lock, [this] {
+        return asyncCalls_ == 0;
+    });
+}
+
+void GGMLModel::beginAsyncCall() {
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    ++asyncCalls_;
+}
+
+void GGMLModel::finishAsyncCall() {
+    // Notify under the lock, the model may be destroyed as soon as it is released
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    --asyncCalls_;
+    asyncCv_.notify_all();
+}
+
 translation::ModelInfo GGMLModel::getModelInfo() const {
     return modelInfo_;
 }
 
+size_t GGMLModel::getMemoryBytes() const {
+    return engine_ ? engine_->getModelMemoryBytes() : 0;
+}
+
 translation::InferenceStats GGMLModel::getLastInferenceStats() const {
     translation::InferenceStats stats;
     engine_->runInference(std::vector<int>(), translation::TranslationOptions(), stats);
@@ -10,15 +10,16 @@
 #include <future>
 #include <vector>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "inference/engine.h"
 #include "interfaces/i_translation_model.h"
 #include "translation/data_structures.h"
+#include "utils/thread_pool.h"
 
 namespace koebridge {
 namespace models {
 
-class ThreadPool;
-
 /**
  * @class GGMLModel
  * @brief Implementation of ITranslationModel for GGML format models
@@ -68,6 +69,20 @@ public:
      */
     std::future<translation::TranslationResult> translateAsync(const std::string& text, const translation::TranslationOptions& options) override;
 
+    /**
+     * @brief Translate text, reporting the output as each token is decoded
+     *
+     * Runs the engine directly, so it only suits a plain GGMLModel; models that decode
+     * through a batch scheduler override it to stream from their scheduled sequence.
+     *
+     * @param text The input text to translate
+     * @param options Translation options and parameters
+     * @param callback Receives each newly decoded piece of text, returns false to stop
+     * @return TranslationResult The translation result
+     */
+    translation::TranslationResult translateStream(const std::string& text, const translation::TranslationOptions& options,
+                                                   const translation::TranslationStreamCallback& callback) override;
+
     /**
      * @brief Get information about the loaded model
      * @return ModelInfo Information about the model
@@ -80,6 +95,12 @@ public:
      */
     translation::InferenceStats getLastInferenceStats() const override;
 
+    /**
+     * @brief Get the memory held by the model weights
+     * @return size_t Mapped or allocated weight bytes, 0 if the model is not loaded
+     */
+    size_t getMemoryBytes() const;
+
 protected:
     /**
      * @brief Convert text to token IDs
@@ -103,13 +124,79 @@ protected:
      */
     void runInference(const std::vector<int>& inputTokens, std::vector<int>& outputTokens, const translation::TranslationOptions& options);
 
+    /**
+     * @brief Check if a request was cancelled or timed out
+     * @param options Options of the request
+     * @return bool True if work on the request should stop
+     */
+    static bool isStopped(const translation::TranslationOptions& options);
+
+    /**
+     * @brief Wrap a token callback so decoding stops once the request is cancelled
+     * @param options Options of the request, holding its cancellation token
+     * @param interrupted Set when the wrapper stopped decoding
+     * @param onToken Callback to wrap, may be empty
+     * @return inference::TokenCallback Callback to pass to the engine
+     */
+    static inference::TokenCallback stopOnCancel(const translation::TranslationOptions& options, bool& interrupted,
+                                                 inference::TokenCallback onToken = nullptr);
+
+    /**
+     * @brief Mark a result as partial because the request was cancelled or timed out
+     * @param options Options of the request
+     * @param result Result holding the text generated so far
+     */
+    static void markInterrupted(const translation::TranslationOptions& options,
+                                translation::TranslationResult& result);
+
+    /**
+     * @brief Run a call on the shared thread pool, tracked until it finishes
+     * @param fn Callable taking no arguments
+     * @return std::future Future for the callable's result
+     */
+    template <typename Fn>
+    auto runAsync(Fn&& fn) {
+        beginAsyncCall();
+        return threadPool_->submit([this, fn = std::forward<Fn>(fn)]() mutable {
+            struct Finish {
+                GGMLModel* model;
+                ~Finish() { model->finishAsyncCall(); }
+            } finish{this};
+            return fn();
+        });
+    }
+
+    /**
+     * @brief Wait until no call started by runAsync() is running or queued
+     *
+     * Pool tasks outlive the futures handed out, so every destructor in the model
+     * hierarchy waits here before releasing what those calls use.
+     */
+    void waitForAsyncCalls();
+
+    /**
+     * @brief Count an asynchronous call that waitForAsyncCalls() waits for
+     *
+     * runAsync() counts its own calls; work finishing on another thread, such as a
+     * scheduled decode, is counted here and ended with finishAsyncCall().
+     */
+    void beginAsyncCall();
+
+    /**
+     * @brief Mark a call counted by beginAsyncCall() as finished
+     */
+    void finishAsyncCall();
+
     translation::ModelInfo modelInfo_;                    ///< Information about the loaded model
     std::unique_ptr<inference::InferenceEngine> engine_; ///< Inference engine for model operations
+    std::shared_ptr<utils::ThreadPool> threadPool_;       ///< Shared pool running asynchronous calls
 
 private:
     bool initialized_ = false;               ///< Model initialization flag
     translation::InferenceStats lastStats_;               ///< Statistics from last inference
-    std::shared_ptr<ThreadPool> threadPool_;  ///< Thread pool for async operations
+    std::mutex asyncMutex_;                  ///< Guards asyncCalls_
+    std::condition_variable asyncCv_;        ///< Signals finished asynchronous calls
+    size_t asyncCalls_ = 0;                  ///< Asynchronous calls not yet finished
 };
 
 } // namespace models
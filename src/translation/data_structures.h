@@ -11,6 +11,8 @@
 #include <chrono>
 #include <filesystem>
 #include <functional>
+#include <memory>
+#include "utils/cancellation_token.h"
 
 namespace koebridge {
 namespace translation {
@@ -42,6 +44,15 @@ struct ModelInfo {
     std::string targetLanguage;        ///< Target language code (for translation models)
 };
 
+/**
+ * @enum TaskPriority
+ * @brief Scheduling priority of a request, most urgent first
+ */
+enum class TaskPriority {
+    LIVE = 0,  ///< Interactive requests such as live speech
+    BULK = 1   ///< Background work such as document batches
+};
+
 /**
  * @struct TranslationOptions
  * @brief Configuration options for translation operations
@@ -58,6 +69,10 @@ struct TranslationOptions {
     int beamSize = 4;                  ///< Beam search size
     Style style = Style::NATURAL;      ///< Translation style
     int timeoutMs = 30000;             ///< Operation timeout in milliseconds
+    std::string sourceLanguage;        ///< Source language code, empty for the model's default
+    std::string targetLanguage;        ///< Target language code, empty for the model's default
+    TaskPriority priority = TaskPriority::LIVE; ///< Queue lane for asynchronous requests
+    std::shared_ptr<utils::CancellationToken> cancellation; ///< Stops the request early, created from timeoutMs if null
 };
 
 /**
@@ -69,6 +84,9 @@ struct InferenceStats {
     double inferenceTimeMs = 0.0;    ///< Model inference time in milliseconds
     int inputTokenCount = 0;         ///< Number of input tokens
     int outputTokenCount = 0;        ///< Number of output tokens
+    int draftTokenCount = 0;         ///< Tokens proposed by the speculative draft model
+    int acceptedDraftTokenCount = 0; ///< Proposed tokens the main model accepted
+    double draftAcceptanceRate = 0.0;///< Accepted share of the proposed tokens
 };
 
 /**
@@ -80,6 +98,8 @@ struct TranslationResult {
     std::string text;                  ///< Translated text
     bool success = false;              ///< Whether translation was successful
     std::string errorMessage;          ///< Error message if translation failed
+    bool partial = false;              ///< Generation was cancelled or timed out, text holds what was produced
+    bool cached = false;               ///< Served from the translation cache without inference
     struct {
         double totalTimeMs = 0.0;      ///< Total processing time
         double inferenceTimeMs = 0.0;  ///< Time spent in inference
@@ -92,5 +112,12 @@ struct TranslationResult {
 
 using ProgressCallback = std::function<void(int progress, const std::string& message)>;
 
+/**
+ * @brief Receives translated text as it is generated
+ * @param textPiece Text completed since the previous call
+ * @return bool False to stop generation early
+ */
+using TranslationStreamCallback = std::function<bool(const std::string& textPiece)>;
+
 } // namespace translation
 } // namespace koebridge
@@ -5,35 +5,48 @@
 
 #include "translation/model_manager.h"
 #include "utils/logger.h"
+#include "utils/config.h"
 #include "models/ggml_model.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QStandardPaths>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 namespace koebridge {
 namespace translation {
 
 ModelManager::ModelManager(const std::string& modelPath)
-    : modelPath_(modelPath)
-    , modelLoaded_(false)
-    , shouldStop_(false) {
+    : modelPath_(modelPath) {
     // Model path is provided by the caller
+    utils::Config& config = utils::Config::getInstance();
+    // Workers block while their request decodes, so their count is the widest batch
+    const int workers = config.getInt("translation.worker_threads", 9);
+    const int liveDepth = config.getInt("translation.live_queue_depth", 32);
+    const int bulkDepth = config.getInt("translation.bulk_queue_depth", 1024);
+    executor_ = std::make_unique<PriorityExecutor>(static_cast<size_t>(std::max(1, workers)),
+                                                   static_cast<size_t>(std::max(0, liveDepth)),
+                                                   static_cast<size_t>(std::max(0, bulkDepth)));
 }
 
 ModelManager::~ModelManager() {
-    // Signal worker thread to stop
+    // Finish the running translations; queued ones are abandoned
+    executor_->stop();
+
+    // Let the loader finish its current load; queued loads are dropped
     {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        shouldStop_ = true;
+        std::lock_guard<std::mutex> lock(loaderMutex_);
+        stopLoader_ = true;
     }
-    queueCV_.notify_one();
-
-    // Wait for worker thread to finish
-    if (workerThread_.joinable()) {
-        workerThread_.join();
+    loaderCV_.notify_one();
+    if (loaderThread_.joinable()) {
+        loaderThread_.join();
+    }
+    for (auto& load : pendingLoads_) {
+        load.promise.set_value(false);
     }
+    pendingLoads_.clear();
 
     unloadCurrentModel();
 }
@@ -74,62 +87,136 @@ bool ModelManager::initialize() {
 }
 
 std::vector<ModelInfo> ModelManager::getAvailableModels() const {
-    std::lock_guard<std::mutex> lock(queueMutex_);
+    std::lock_guard<std::mutex> lock(modelsMutex_);
     return availableModels_;
 }
 
 ModelInfo ModelManager::getActiveModel() const {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    if (!modelLoaded_) {
-        return ModelInfo{};
-    }
-    return activeModel_;
+    auto active = activeSnapshot();
+    return active ? active->info : ModelInfo{};
+}
+
+std::shared_ptr<const ModelManager::ActiveModel> ModelManager::activeSnapshot() const {
+    return std::atomic_load(&active_);
 }
 
 bool ModelManager::loadModel(const std::string& modelId) {
-    std::lock_guard<std::mutex> modelsLock(modelsMutex_);
-    std::lock_guard<std::mutex> modelLock(modelMutex_);
+    return loadModelAsync(modelId).get();
+}
 
-    // Check if this model is already loaded
-    if (modelLoaded_ && activeModel_.id == modelId) {
-        return true;
+std::future<bool> ModelManager::loadModelAsync(const std::string& modelId, ProgressCallback callback) {
+    PendingLoad load;
+    load.modelId = modelId;
+    load.callback = std::move(callback);
+    auto future = load.promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(loaderMutex_);
+        if (stopLoader_) {
+            load.promise.set_value(false);
+            return future;
+        }
+        pendingLoads_.push_back(std::move(load));
+        if (!loaderThread_.joinable()) {
+            loaderThread_ = std::thread(&ModelManager::processLoadQueue, this);
+        }
     }
+    loaderCV_.notify_one();
 
-    // Find the model in the available models list
-    for (const auto& model : availableModels_) {
-        if (model.id == modelId) {
-            // Unload current model if any
-            if (modelLoaded_) {
-                unloadModel();
-            }
+    return future;
+}
+
+void ModelManager::processLoadQueue() {
+    while (true) {
+        PendingLoad load;
+        {
+            std::unique_lock<std::mutex> lock(loaderMutex_);
+            loaderCV_.wait(lock, [this] {
+                return !pendingLoads_.empty() || stopLoader_;
+            });
 
-            utils::Logger::getInstance().info("Creating GGML model for: " + modelId);
+            if (stopLoader_) {
+                break;
+            }
 
-            // Create and initialize the GGML model
-            model_ = std::make_shared<models::GGMLModel>(model);
+            load = std::move(pendingLoads_.front());
+            pendingLoads_.pop_front();
+        }
 
-            utils::Logger::getInstance().info("Starting model initialization for: " + modelId);
-            if (!model_->initialize()) {
-                utils::Logger::getInstance().error("Failed to initialize model: " + modelId);
-                model_.reset();
-                return false;
+        bool loaded = false;
+        try {
+            loaded = performLoad(load.modelId, load.callback);
+        } catch (const std::exception& e) {
+            utils::Logger::getInstance().error("Error loading model " + load.modelId + ": " + e.what());
+            if (load.callback) {
+                load.callback(100, "Failed to load model: " + load.modelId);
             }
+        }
+        load.promise.set_value(loaded);
+    }
+}
 
-            // Update model info
-            activeModel_ = model;
-            modelLoaded_ = true;
-            utils::Logger::getInstance().info("Successfully loaded model: " + modelId);
-            return true;
+bool ModelManager::performLoad(const std::string& modelId, const ProgressCallback& callback) {
+    std::lock_guard<std::mutex> loadLock(modelMutex_);
+    auto report = [&callback](int progress, const std::string& message) {
+        if (callback) {
+            callback(progress, message);
         }
+    };
+
+    // Check if this model is already loaded
+    auto current = activeSnapshot();
+    if (current && current->info.id == modelId) {
+        report(100, "Model already loaded: " + modelId);
+        return true;
     }
 
-    utils::Logger::getInstance().error("Model not found: " + modelId);
-    return false;
+    // Find the model in the available models list
+    ModelInfo info;
+    {
+        std::lock_guard<std::mutex> lock(modelsMutex_);
+        auto it = std::find_if(availableModels_.begin(), availableModels_.end(), [&](const ModelInfo& model) {
+            return model.id == modelId;
+        });
+        if (it == availableModels_.end()) {
+            utils::Logger::getInstance().error("Model not found: " + modelId);
+            report(100, "Model not found: " + modelId);
+            return false;
+        }
+        info = *it;
+    }
+
+    utils::Logger::getInstance().info("Creating GGML model for: " + modelId);
+    report(0, "Loading model: " + modelId);
+
+    // Read the weights without holding any lock, the current model keeps serving
+    std::shared_ptr<ITranslationModel> model = std::make_shared<models::GGMLModel>(info);
+
+    utils::Logger::getInstance().info("Starting model initialization for: " + modelId);
+    report(10, "Reading model weights: " + modelId);
+    if (!model->initialize()) {
+        utils::Logger::getInstance().error("Failed to initialize model: " + modelId);
+        report(100, "Failed to initialize model: " + modelId);
+        return false;
+    }
+
+    // Publish the new model; readers pick it up with their next snapshot
+    report(90, "Switching to model: " + modelId);
+    auto next = std::make_shared<ActiveModel>();
+    next->info = info;
+    next->model = std::move(model);
+    auto previous = std::atomic_exchange(&active_, std::shared_ptr<const ActiveModel>(std::move(next)));
+
+    // Requests still holding the old model release its weights when they finish
+    previous.reset();
+
+    utils::Logger::getInstance().info("Successfully loaded model: " + modelId);
+    report(100, "Model ready: " + modelId);
+    return true;
 }
 
 bool ModelManager::unloadModel() {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    if (!modelLoaded_) {
+    if (!activeSnapshot()) {
         return true;  // Nothing to unload
     }
 
@@ -138,8 +225,7 @@ bool ModelManager::unloadModel() {
 }
 
 bool ModelManager::isModelLoaded() const {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    return modelLoaded_;
+    return activeSnapshot() != nullptr;
 }
 
 bool ModelManager::downloadModel(const std::string& modelId, ProgressCallback callback) {
@@ -171,31 +257,34 @@ bool ModelManager::downloadModel(const std::string& modelId, ProgressCallback ca
 }
 
 void ModelManager::unloadCurrentModel() {
-    // Reset the state
-    model_.reset();
-    modelLoaded_ = false;
-    activeModel_ = ModelInfo{};
+    // In-flight translations keep their snapshot until they finish
+    std::atomic_store(&active_, std::shared_ptr<const ActiveModel>());
 }
 
 std::shared_ptr<ITranslationModel> ModelManager::getTranslationModel() {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    if (!modelLoaded_) {
-        return nullptr;
-    }
-
-    return model_;
+    auto active = activeSnapshot();
+    return active ? active->model : nullptr;
 }
 
 TranslationResult ModelManager::translate(const std::string& text, const TranslationOptions& options) {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    if (!modelLoaded_ || !model_) {
+    // The snapshot keeps the model alive for the call, no manager lock is held
+    auto active = activeSnapshot();
+    if (!active || !active->model) {
         TranslationResult result;
         result.success = false;
         result.errorMessage = "No model loaded";
         return result;
     }
 
-    return model_->translate(text, options);
+    return active->model->translate(text, withDeadline(options));
+}
+
+TranslationOptions ModelManager::withDeadline(const TranslationOptions& options) {
+    TranslationOptions bounded = options;
+    if (!bounded.cancellation) {
+        bounded.cancellation = utils::CancellationToken::withTimeout(options.timeoutMs);
+    }
+    return bounded;
 }
 
 std::future<TranslationResult> ModelManager::translateAsync(
@@ -206,30 +295,8 @@ std::future<TranslationResult> ModelManager::translateAsync(
     return queueTranslation(text, options, progressCallback);
 }
 
-void ModelManager::processTranslationQueue() {
-    while (true) {
-        std::function<void()> task;
-
-        {
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            queueCV_.wait(lock, [this] {
-                return !translationQueue_.empty() || shouldStop_;
-            });
-
-            if (shouldStop_ && translationQueue_.empty()) {
-                break;
-            }
-
-            if (!translationQueue_.empty()) {
-                task = std::move(translationQueue_.front());
-                translationQueue_.pop();
-            }
-        }
-
-        if (task) {
-            task();
-        }
-    }
+LaneStats ModelManager::getLaneStats(TaskPriority priority) const {
+    return executor_->getStats(priority);
 }
 
 std::future<TranslationResult> ModelManager::queueTranslation(
@@ -240,8 +307,19 @@ std::future<TranslationResult> ModelManager::queueTranslation(
     auto promise = std::make_shared<std::promise<TranslationResult>>();
     auto future = promise->get_future();
 
-    auto task = [this, text, options, progressCallback, promise]() {
+    // The deadline starts at submission, time spent queued counts against it
+    auto task = [this, text, options = withDeadline(options), progressCallback, promise]() {
         try {
+            // Requests cancelled or expired while queued never reach the model
+            if (options.cancellation->shouldStop()) {
+                TranslationResult stopped;
+                stopped.sourceText = text;
+                stopped.success = false;
+                stopped.errorMessage = options.cancellation->stopReason();
+                promise->set_value(std::move(stopped));
+                return;
+            }
+
             if (progressCallback) {
                 progressCallback(0, "Starting translation");
             }
@@ -261,11 +339,23 @@ std::future<TranslationResult> ModelManager::queueTranslation(
         }
     };
 
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        translationQueue_.push(std::move(task));
+    // Requests still queued when the service shuts down get a result instead of a broken promise
+    auto abandon = [text, promise]() {
+        TranslationResult abandoned;
+        abandoned.sourceText = text;
+        abandoned.success = false;
+        abandoned.errorMessage = "translation service shutting down";
+        promise->set_value(std::move(abandoned));
+    };
+
+    if (!executor_->submit(options.priority, std::move(task), std::move(abandon))) {
+        TranslationResult rejected;
+        rejected.sourceText = text;
+        rejected.success = false;
+        rejected.errorMessage = "Translation queue full";
+        utils::Logger::getInstance().warning("Rejected translation request: queue full");
+        promise->set_value(std::move(rejected));
     }
-    queueCV_.notify_one();
 
     return future;
 }
@@ -284,8 +374,8 @@ bool ModelManager::scanForModels() {
         // Get all files in the directory
         QFileInfoList files = dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
         for (const QFileInfo& file : files) {
-            // Check if file is a model file (has .bin extension)
-            if (file.suffix() == "bin") {
+            // Check if file is a model file (legacy .bin or GGUF)
+            if (file.suffix() == "bin" || file.suffix() == "gguf") {
                 ModelInfo modelInfo;
                 modelInfo.id = file.baseName().toStdString();
                 modelInfo.path = file.absoluteFilePath().toStdString();
@@ -11,11 +11,13 @@
 #include <functional>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <deque>
+#include <future>
 #include <thread>
 #include "interfaces/i_model_manager.h"
 #include "interfaces/i_translation_model.h"
 #include "data_structures.h"
+#include "priority_executor.h"
 
 namespace koebridge {
 namespace translation {
@@ -31,6 +33,12 @@ class ModelManager : public IModelManager {
 public:
     /**
      * @brief Constructor
+     *
+     * Each executor worker blocks in translate() while the model's scheduler decodes,
+     * so translation.worker_threads caps how many requests share a decode batch; bulk
+     * requests fill at most one worker less. The default leaves the bulk lane enough
+     * workers to fill a batch of LLMConfig::maxBatchSize rows.
+     *
      * @param modelPath Optional path to override the config setting
      */
     explicit ModelManager(const std::string& modelPath = "");
@@ -51,8 +59,26 @@ public:
     std::shared_ptr<ITranslationModel> getTranslationModel() override;
 
     // Additional methods specific to ModelManager
+    /**
+     * @brief Load a model on the background loader thread
+     *
+     * The current model keeps serving translations while the new one reads its
+     * weights. Once it is ready it is published in place of the current model in one
+     * step; requests still holding the old model keep it alive until they are done.
+     * Loads run one at a time, in the order requested.
+     *
+     * @param modelId ID of the model to load
+     * @param callback Optional callback for progress updates, called on the loader thread
+     * @return std::future<bool> Future completed with true once the model is active
+     */
+    std::future<bool> loadModelAsync(const std::string& modelId, ProgressCallback callback = nullptr);
+
     /**
      * @brief Translate text synchronously
+     *
+     * Without a cancellation token in the options the request gets one expiring
+     * after options.timeoutMs.
+     *
      * @param text Text to translate
      * @param options Translation options
      * @return TranslationResult Translation result
@@ -61,6 +87,12 @@ public:
 
     /**
      * @brief Translate text asynchronously
+     *
+     * The request runs on the manager's executor in the lane given by
+     * options.priority. If that lane's queue is full the future completes right away
+     * with an error. The timeout counts from submission; a request cancelled or
+     * expired while it waits is failed without running.
+     *
      * @param text Text to translate
      * @param options Translation options
      * @param progressCallback Optional callback for progress updates
@@ -72,6 +104,13 @@ public:
         ProgressCallback progressCallback = nullptr
     );
 
+    /**
+     * @brief Get queue depth and latency counters of an executor lane
+     * @param priority The lane
+     * @return LaneStats Snapshot of the lane's counters
+     */
+    LaneStats getLaneStats(TaskPriority priority) const;
+
 private:
     /**
      * @brief Get the model path from config or use default
@@ -91,12 +130,52 @@ private:
     void unloadCurrentModel();
 
     /**
-     * @brief Process the translation queue
+     * @struct ActiveModel
+     * @brief Immutable snapshot of the loaded model, published as a whole
+     */
+    struct ActiveModel {
+        ModelInfo info;                        ///< Information about the model
+        std::shared_ptr<ITranslationModel> model; ///< The loaded model
+    };
+
+    /**
+     * @brief Take a reference to the active model without locking
+     * @return std::shared_ptr<const ActiveModel> The active model, nullptr if none is loaded
+     */
+    std::shared_ptr<const ActiveModel> activeSnapshot() const;
+
+    /**
+     * @struct PendingLoad
+     * @brief A model load waiting for the loader thread
+     */
+    struct PendingLoad {
+        std::string modelId;                   ///< ID of the model to load
+        ProgressCallback callback;             ///< Progress callback
+        std::promise<bool> promise;            ///< Completed when the load finishes
+    };
+
+    /**
+     * @brief Loader thread main loop
+     */
+    void processLoadQueue();
+
+    /**
+     * @brief Load a model and swap it in for the current one
+     * @param modelId ID of the model to load
+     * @param callback Optional progress callback
+     * @return bool True if the model is active
+     */
+    bool performLoad(const std::string& modelId, const ProgressCallback& callback);
+
+    /**
+     * @brief Give options without a cancellation token one expiring after their timeout
+     * @param options Translation options
+     * @return TranslationOptions Copy of the options with a cancellation token
      */
-    void processTranslationQueue();
+    static TranslationOptions withDeadline(const TranslationOptions& options);
 
     /**
-     * @brief Add a translation request to the queue
+     * @brief Add a translation request to the executor
      * @param text Text to translate
      * @param options Translation options
      * @param progressCallback Progress callback
@@ -110,17 +189,16 @@ private:
 
     std::string modelPath_;                    ///< Path to the model directory
     bool initialized_ = false;                 ///< Initialization state
-    bool modelLoaded_ = false;                 ///< Model loading state
     std::vector<ModelInfo> availableModels_;   ///< List of available models
-    ModelInfo activeModel_;                    ///< Currently active model
-    std::shared_ptr<ITranslationModel> model_; ///< Currently loaded model
-    mutable std::mutex modelMutex_;            ///< Mutex for model operations
+    std::shared_ptr<const ActiveModel> active_; ///< Loaded model, accessed only through std::atomic_load/store
+    mutable std::mutex modelMutex_;            ///< Serializes model loads
     mutable std::mutex modelsMutex_;           ///< Mutex for available models list
-    mutable std::mutex queueMutex_;            ///< Mutex for translation queue
-    std::condition_variable queueCV_;          ///< Condition variable for queue processing
-    std::queue<std::function<void()>> translationQueue_; ///< Queue of translation tasks
-    std::thread workerThread_;                 ///< Worker thread for processing queue
-    bool shouldStop_ = false;                  ///< Flag to signal worker thread to stop
+    std::unique_ptr<PriorityExecutor> executor_; ///< Runs asynchronous translations by priority
+    std::mutex loaderMutex_;                   ///< Mutex for the load queue
+    std::condition_variable loaderCV_;         ///< Signals new loads or shutdown
+    std::deque<PendingLoad> pendingLoads_;     ///< Loads waiting for the loader thread
+    std::thread loaderThread_;                 ///< Background model loader thread
+    bool stopLoader_ = false;                  ///< Flag to signal the loader thread to stop
 };
 
 } // namespace translation
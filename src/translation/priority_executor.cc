@@ -0,0 +1,163 @@
+/**
+ * @file priority_executor.cc
+ * @brief Implementation of the priority executor
+ */
+
+#include "translation/priority_executor.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <iterator>
+
+namespace koebridge {
+namespace translation {
+
+PriorityExecutor::PriorityExecutor(size_t numThreads, size_t maxLiveQueue, size_t maxBulkQueue) {
+    numThreads = std::max<size_t>(1, numThreads);
+    maxBulkRunning_ = numThreads > 1 ? numThreads - 1 : 1;
+    lanes_[static_cast<size_t>(TaskPriority::LIVE)].maxQueue = maxLiveQueue;
+    lanes_[static_cast<size_t>(TaskPriority::BULK)].maxQueue = maxBulkQueue;
+
+    workers_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&PriorityExecutor::workerLoop, this);
+    }
+}
+
+PriorityExecutor::~PriorityExecutor() {
+    stop();
+}
+
+bool PriorityExecutor::submit(TaskPriority priority, std::function<void()> task, std::function<void()> abandon) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Lane& lane = lanes_[static_cast<size_t>(priority)];
+        if (stopping_ || (lane.maxQueue != 0 && lane.queue.size() >= lane.maxQueue)) {
+            ++lane.rejected;
+            return false;
+        }
+        lane.queue.push_back(Task{std::move(task), std::move(abandon), Clock::now()});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void PriorityExecutor::stop() {
+    std::vector<Task> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        for (Lane& lane : lanes_) {
+            std::move(lane.queue.begin(), lane.queue.end(), std::back_inserter(abandoned));
+            lane.queue.clear();
+        }
+    }
+    cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    if (!abandoned.empty()) {
+        LOG_WARNING("Executor stopped with " + std::to_string(abandoned.size()) + " queued tasks");
+    }
+    // Outside the lock, so the abandon functions may fail their promises and submit nothing new
+    for (Task& task : abandoned) {
+        if (!task.abandon) {
+            continue;
+        }
+        try {
+            task.abandon();
+        } catch (const std::exception& e) {
+            LOG_ERROR(std::string("Abandoning executor task failed: ") + e.what());
+        }
+    }
+}
+
+LaneStats PriorityExecutor::getStats(TaskPriority priority) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Lane& lane = lanes_[static_cast<size_t>(priority)];
+
+    LaneStats stats;
+    stats.queued = lane.queue.size();
+    stats.running = lane.running;
+    stats.completed = lane.completed;
+    stats.rejected = lane.rejected;
+    stats.maxQueueMs = lane.maxQueueMs;
+    if (lane.completed > 0) {
+        stats.averageQueueMs = lane.totalQueueMs / lane.completed;
+        stats.averageRunMs = lane.totalRunMs / lane.completed;
+    }
+    return stats;
+}
+
+size_t PriorityExecutor::getThreadCount() const {
+    return workers_.size();
+}
+
+int PriorityExecutor::nextLane() const {
+    for (size_t i = 0; i < kLaneCount; ++i) {
+        const Lane& lane = lanes_[i];
+        if (lane.queue.empty()) {
+            continue;
+        }
+        // Keep a worker free for live requests
+        if (i == static_cast<size_t>(TaskPriority::BULK) && lane.running >= maxBulkRunning_) {
+            continue;
+        }
+        return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void PriorityExecutor::workerLoop() {
+    while (true) {
+        Task task;
+        Lane* lane = nullptr;
+        Clock::time_point startedAt;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] {
+                return stopping_ || nextLane() >= 0;
+            });
+
+            if (stopping_) {
+                break;
+            }
+
+            lane = &lanes_[nextLane()];
+            task = std::move(lane->queue.front());
+            lane->queue.pop_front();
+            lane->running++;
+
+            startedAt = Clock::now();
+            const double queueMs = std::chrono::duration<double, std::milli>(startedAt - task.submittedAt).count();
+            lane->totalQueueMs += queueMs;
+            lane->maxQueueMs = std::max(lane->maxQueueMs, queueMs);
+        }
+
+        try {
+            task.run();
+        } catch (const std::exception& e) {
+            LOG_ERROR(std::string("Executor task failed: ") + e.what());
+        }
+        task.run = nullptr;
+        task.abandon = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lane->running--;
+            lane->completed++;
+            lane->totalRunMs += std::chrono::duration<double, std::milli>(Clock::now() - startedAt).count();
+        }
+        // A finished bulk task may unblock a waiting one
+        cv_.notify_one();
+    }
+}
+
+} // namespace translation
+} // namespace koebridge
@@ -0,0 +1,137 @@
+/**
+ * @file priority_executor.h
+ * @brief Fixed-size thread pool that runs live requests ahead of bulk work
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "translation/data_structures.h"
+
+namespace koebridge {
+namespace translation {
+
+/**
+ * @struct LaneStats
+ * @brief Queue depth and latency counters of one executor lane
+ */
+struct LaneStats {
+    size_t queued = 0;                 ///< Tasks waiting for a worker
+    size_t running = 0;                ///< Tasks currently running
+    uint64_t completed = 0;            ///< Tasks that finished
+    uint64_t rejected = 0;             ///< Tasks refused because the lane was full
+    double averageQueueMs = 0.0;       ///< Mean time from submission to start
+    double maxQueueMs = 0.0;           ///< Longest time from submission to start
+    double averageRunMs = 0.0;         ///< Mean time a task ran
+};
+
+/**
+ * @class PriorityExecutor
+ * @brief Runs tasks on a fixed set of worker threads, live lane first
+ *
+ * Idle workers always take the oldest live task before any bulk task. Bulk tasks
+ * never occupy every worker, so with two or more threads one worker is always free
+ * for live requests and they never wait behind a running batch. Each lane has its
+ * own queue depth limit; submissions beyond it are rejected rather than left to
+ * grow the backlog.
+ */
+class PriorityExecutor {
+public:
+    static constexpr size_t kLaneCount = 2;    ///< Number of priority lanes
+
+    /**
+     * @brief Constructor for PriorityExecutor, starts the workers
+     * @param numThreads Number of worker threads
+     * @param maxLiveQueue Maximum waiting live tasks, 0 for no limit
+     * @param maxBulkQueue Maximum waiting bulk tasks, 0 for no limit
+     */
+    PriorityExecutor(size_t numThreads, size_t maxLiveQueue, size_t maxBulkQueue);
+
+    /**
+     * @brief Destructor, stops the workers
+     */
+    ~PriorityExecutor();
+
+    PriorityExecutor(const PriorityExecutor&) = delete;
+    PriorityExecutor& operator=(const PriorityExecutor&) = delete;
+
+    /**
+     * @brief Queue a task in a lane
+     * @param priority Lane to queue the task in
+     * @param task Task to run on a worker thread
+     * @param abandon Called instead of the task if the executor stops before running it
+     * @return bool False if the lane is full or the executor stopped; neither function is run
+     */
+    bool submit(TaskPriority priority, std::function<void()> task, std::function<void()> abandon = nullptr);
+
+    /**
+     * @brief Stop the workers after the running tasks finish
+     *
+     * Tasks still waiting never run; their abandon functions are called instead, on
+     * the calling thread once the workers have exited.
+     */
+    void stop();
+
+    /**
+     * @brief Get the counters of a lane
+     * @param priority The lane
+     * @return LaneStats Snapshot of the lane's counters
+     */
+    LaneStats getStats(TaskPriority priority) const;
+
+    /**
+     * @brief Get the number of worker threads
+     * @return size_t Worker count
+     */
+    size_t getThreadCount() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task {
+        std::function<void()> run;
+        std::function<void()> abandon;
+        Clock::time_point submittedAt;
+    };
+
+    struct Lane {
+        std::deque<Task> queue;
+        size_t maxQueue = 0;
+        size_t running = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;
+        double totalQueueMs = 0.0;
+        double maxQueueMs = 0.0;
+        double totalRunMs = 0.0;
+    };
+
+    /**
+     * @brief Worker thread main loop
+     */
+    void workerLoop();
+
+    /**
+     * @brief Pick the lane the next task comes from
+     * @return int Lane index, -1 if no task may start now; requires mutex_
+     */
+    int nextLane() const;
+
+    std::array<Lane, kLaneCount> lanes_;       ///< Per-priority queues and counters
+    std::vector<std::thread> workers_;         ///< Worker threads
+    size_t maxBulkRunning_;                    ///< Workers bulk tasks may occupy at once
+    mutable std::mutex mutex_;                 ///< Guards lanes_ and stopping_
+    std::condition_variable cv_;               ///< Signals new tasks, freed workers or shutdown
+    bool stopping_ = false;                    ///< Workers exit once set
+};
+
+} // namespace translation
+} // namespace koebridge
@@ -0,0 +1,524 @@
+/**
+ * @file translation_memory.cc
+ * @brief Implementation of the persistent translation memory
+ */
+
+#include "translation/translation_memory.h"
+#include "utils/logger.h"
+#include <cstring>
+#include <filesystem>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace koebridge {
+namespace translation {
+
+namespace {
+
+constexpr char kLogMagic[8] = {'K', 'B', 'T', 'M', 'L', 'O', 'G', '1'};
+constexpr char kIndexMagic[8] = {'K', 'B', 'T', 'M', 'I', 'D', 'X', '1'};
+constexpr uint64_t kLogHeaderBytes = sizeof(kLogMagic);
+constexpr size_t kInitialCapacity = 4096;      // index slots, a power of two
+constexpr uint32_t kMaxFieldBytes = 1u << 20;  // anything larger is a damaged record
+constexpr size_t kMaxQueuedWrites = 4096;
+
+// Fixed-size prefix of every log record, followed by the key and the text
+struct RecordHeader {
+    uint32_t keyBytes;
+    uint32_t textBytes;
+    uint64_t checksum;
+};
+
+// FNV-1a, continued from a previous hash to cover several fields
+uint64_t fnv1a(const std::string& data, uint64_t hash = 1469598103934665603ULL) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool readFully(int fd, void* buffer, size_t size, uint64_t offset) {
+    char* out = static_cast<char*>(buffer);
+    while (size > 0) {
+        const ssize_t n = ::pread(fd, out, size, static_cast<off_t>(offset));
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* buffer, size_t size, uint64_t offset) {
+    const char* in = static_cast<const char*>(buffer);
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, in, size, static_cast<off_t>(offset));
+        if (n <= 0) {
+            return false;
+        }
+        in += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+struct TranslationMemory::IndexHeader {
+    char magic[8];
+    uint64_t capacity;     // number of slots, a power of two
+    uint64_t count;        // occupied slots
+    uint64_t logBytes;     // prefix of the log covered by the index
+};
+
+struct TranslationMemory::IndexSlot {
+    uint64_t hash;         // key hash
+    uint64_t offset;       // record offset in the log, 0 for an empty slot
+};
+
+TranslationMemory::TranslationMemory() = default;
+
+TranslationMemory::~TranslationMemory() {
+    close();
+}
+
+bool TranslationMemory::open(const std::string& directory, size_t maxLogBytes) {
+    close();
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        LOG_ERROR("Failed to create translation memory directory: " + directory);
+        return false;
+    }
+
+    const std::string logPath = (std::filesystem::path(directory) / "memory.log").string();
+    const std::string indexPath = (std::filesystem::path(directory) / "memory.idx").string();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    logFd_ = ::open(logPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (logFd_ < 0) {
+        LOG_ERROR("Failed to open translation memory log: " + logPath);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(logFd_, &st) != 0) {
+        LOG_ERROR("Failed to stat translation memory log: " + logPath);
+        closeFiles();
+        return false;
+    }
+    if (st.st_size == 0) {
+        if (!writeFully(logFd_, kLogMagic, sizeof(kLogMagic), 0)) {
+            LOG_ERROR("Failed to initialize translation memory log: " + logPath);
+            closeFiles();
+            return false;
+        }
+    } else {
+        // Never overwrite a file that is not ours
+        char magic[sizeof(kLogMagic)];
+        if (!readFully(logFd_, magic, sizeof(magic), 0) || std::memcmp(magic, kLogMagic, sizeof(magic)) != 0) {
+            LOG_ERROR("Not a translation memory log: " + logPath);
+            closeFiles();
+            return false;
+        }
+    }
+
+    maxLogBytes_ = maxLogBytes;
+    full_ = false;
+    if (!openIndex(indexPath) || !catchUpIndex()) {
+        closeFiles();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> queueLock(queueMutex_);
+        stopping_ = false;
+    }
+    writer_ = std::thread(&TranslationMemory::writerLoop, this);
+
+    LOG_INFO("Translation memory opened with " + std::to_string(header()->count) + " entries: " + directory);
+    return true;
+}
+
+void TranslationMemory::close() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueCv_.notify_all();
+
+    // The writer empties the queue before it exits
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeFiles();
+}
+
+bool TranslationMemory::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mapping_ != nullptr;
+}
+
+bool TranslationMemory::lookup(const std::string& key, std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!mapping_) {
+        return false;
+    }
+
+    const uint64_t hash = fnv1a(key);
+    const uint64_t mask = header()->capacity - 1;
+    for (uint64_t i = hash & mask; slotTable()[i].offset != 0; i = (i + 1) & mask) {
+        if (slotTable()[i].hash != hash) {
+            continue;
+        }
+        std::string storedKey;
+        std::string storedText;
+        uint64_t next = 0;
+        if (readRecord(slotTable()[i].offset, storedKey, storedText, next) && storedKey == key) {
+            text = std::move(storedText);
+            ++hits_;
+            return true;
+        }
+    }
+
+    ++misses_;
+    return false;
+}
+
+void TranslationMemory::store(const std::string& key, const std::string& text) {
+    if (!isOpen()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (stopping_) {
+            return;
+        }
+        if (writeQueue_.size() >= kMaxQueuedWrites) {
+            std::lock_guard<std::mutex> counterLock(mutex_);
+            ++dropped_;
+            return;
+        }
+        writeQueue_.emplace_back(key, text);
+    }
+    queueCv_.notify_all();
+}
+
+void TranslationMemory::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    queueCv_.wait(lock, [this] {
+        return writeQueue_.empty() && !writing_;
+    });
+}
+
+TranslationMemoryStats TranslationMemory::getStats() const {
+    TranslationMemoryStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.writes = writes_;
+        stats.dropped = dropped_;
+        if (mapping_) {
+            stats.entries = header()->count;
+            stats.logBytes = header()->logBytes;
+        }
+    }
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stats.pendingWrites = writeQueue_.size();
+    return stats;
+}
+
+void TranslationMemory::writerLoop() {
+    while (true) {
+        std::deque<std::pair<std::string, std::string>> batch;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueCv_.wait(lock, [this] {
+                return stopping_ || !writeQueue_.empty();
+            });
+            if (writeQueue_.empty()) {
+                break;  // stopping with nothing left to write
+            }
+            batch.swap(writeQueue_);
+            writing_ = true;
+        }
+
+        // Lock per record so a lookup waits for at most one append, not the whole batch
+        for (const auto& entry : batch) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            append(entry.first, entry.second);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            writing_ = false;
+        }
+        queueCv_.notify_all();
+    }
+}
+
+bool TranslationMemory::append(const std::string& key, const std::string& text) {
+    if (!mapping_) {
+        return false;
+    }
+    if (key.size() > kMaxFieldBytes || text.size() > kMaxFieldBytes) {
+        ++dropped_;
+        return false;
+    }
+
+    const uint64_t offset = header()->logBytes;
+    const size_t recordBytes = sizeof(RecordHeader) + key.size() + text.size();
+    if (maxLogBytes_ != 0 && offset + recordBytes > maxLogBytes_) {
+        if (!full_) {
+            LOG_WARNING("Translation memory reached its size limit, new entries are not stored");
+            full_ = true;
+        }
+        ++dropped_;
+        return false;
+    }
+
+    RecordHeader record;
+    record.keyBytes = static_cast<uint32_t>(key.size());
+    record.textBytes = static_cast<uint32_t>(text.size());
+    record.checksum = fnv1a(text, fnv1a(key));
+
+    std::string buffer;
+    buffer.reserve(recordBytes);
+    buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    buffer.append(key);
+    buffer.append(text);
+
+    // The record is complete in the log before the index points at it
+    if (!writeFully(logFd_, buffer.data(), buffer.size(), offset)) {
+        LOG_ERROR("Failed to append to the translation memory log");
+        return false;
+    }
+    if (!indexRecord(key, fnv1a(key), offset)) {
+        return false;
+    }
+    header()->logBytes = offset + recordBytes;
+    ++writes_;
+    return true;
+}
+
+bool TranslationMemory::openIndex(const std::string& path) {
+    indexPath_ = path;
+    indexFd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (indexFd_ < 0) {
+        LOG_ERROR("Failed to open translation memory index: " + path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(indexFd_, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(IndexHeader)) {
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, indexFd_, 0);
+        if (mapping != MAP_FAILED) {
+            const IndexHeader* existing = static_cast<const IndexHeader*>(mapping);
+            const uint64_t capacity = existing->capacity;
+            const bool valid = std::memcmp(existing->magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+                capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+                size == sizeof(IndexHeader) + capacity * sizeof(IndexSlot) &&
+                existing->count < capacity && existing->logBytes >= kLogHeaderBytes;
+            if (valid) {
+                mapping_ = mapping;
+                mappingSize_ = size;
+                return true;
+            }
+            munmap(mapping, size);
+        }
+        LOG_WARNING("Rebuilding translation memory index: " + path);
+    }
+
+    return createIndex(kInitialCapacity);
+}
+
+bool TranslationMemory::createIndex(size_t capacity) {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+
+    // Truncating first zero-fills the whole table
+    const size_t size = sizeof(IndexHeader) + capacity * sizeof(IndexSlot);
+    if (ftruncate(indexFd_, 0) != 0 || ftruncate(indexFd_, static_cast<off_t>(size)) != 0) {
+        LOG_ERROR("Failed to size translation memory index: " + indexPath_);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, indexFd_, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to map translation memory index: " + indexPath_);
+        return false;
+    }
+    mapping_ = mapping;
+    mappingSize_ = size;
+
+    std::memcpy(header()->magic, kIndexMagic, sizeof(kIndexMagic));
+    header()->capacity = capacity;
+    header()->count = 0;
+    header()->logBytes = kLogHeaderBytes;
+    return true;
+}
+
+bool TranslationMemory::catchUpIndex() {
+    struct stat st;
+    if (fstat(logFd_, &st) != 0) {
+        return false;
+    }
+    const uint64_t logSize = static_cast<uint64_t>(st.st_size);
+
+    // An index ahead of the log belongs to another log, start over
+    if (header()->logBytes > logSize && !createIndex(header()->capacity)) {
+        return false;
+    }
+
+    uint64_t offset = header()->logBytes;
+    size_t recovered = 0;
+    while (offset < logSize) {
+        std::string key;
+        std::string text;
+        uint64_t next = 0;
+        if (!readRecord(offset, key, text, next)) {
+            // A write cut short by a crash, drop it so appends continue from a clean end
+            LOG_WARNING("Truncating damaged translation memory record at offset " + std::to_string(offset));
+            if (ftruncate(logFd_, static_cast<off_t>(offset)) != 0) {
+                LOG_ERROR("Failed to truncate the translation memory log");
+                return false;
+            }
+            break;
+        }
+        if (!indexRecord(key, fnv1a(key), offset)) {
+            return false;
+        }
+        offset = next;
+        ++recovered;
+    }
+    header()->logBytes = offset;
+
+    if (recovered > 0) {
+        LOG_INFO("Indexed " + std::to_string(recovered) + " translation memory records from the log");
+    }
+    return true;
+}
+
+bool TranslationMemory::indexRecord(const std::string& key, uint64_t hash, uint64_t offset) {
+    // Keep the table at most 70% full so probe sequences stay short
+    if ((header()->count + 1) * 10 > header()->capacity * 7 && !growIndex()) {
+        return false;
+    }
+
+    const uint64_t mask = header()->capacity - 1;
+    uint64_t i = hash & mask;
+    for (; slotTable()[i].offset != 0; i = (i + 1) & mask) {
+        if (slotTable()[i].hash != hash) {
+            continue;
+        }
+        // A newer record for the same key replaces the older one
+        std::string storedKey;
+        std::string storedText;
+        uint64_t next = 0;
+        if (readRecord(slotTable()[i].offset, storedKey, storedText, next) && storedKey == key) {
+            slotTable()[i].offset = offset;
+            return true;
+        }
+    }
+
+    slotTable()[i].hash = hash;
+    slotTable()[i].offset = offset;
+    header()->count++;
+    return true;
+}
+
+bool TranslationMemory::growIndex() {
+    std::vector<IndexSlot> occupied;
+    occupied.reserve(header()->count);
+    for (uint64_t i = 0; i < header()->capacity; ++i) {
+        if (slotTable()[i].offset != 0) {
+            occupied.push_back(slotTable()[i]);
+        }
+    }
+    const uint64_t logBytes = header()->logBytes;
+
+    if (!createIndex(header()->capacity * 2)) {
+        return false;
+    }
+
+    const uint64_t mask = header()->capacity - 1;
+    for (const IndexSlot& slot : occupied) {
+        uint64_t i = slot.hash & mask;
+        while (slotTable()[i].offset != 0) {
+            i = (i + 1) & mask;
+        }
+        slotTable()[i] = slot;
+    }
+    header()->count = occupied.size();
+    header()->logBytes = logBytes;
+    return true;
+}
+
+bool TranslationMemory::readRecord(uint64_t offset, std::string& key, std::string& text, uint64_t& next) const {
+    RecordHeader record;
+    if (!readFully(logFd_, &record, sizeof(record), offset)) {
+        return false;
+    }
+    if (record.keyBytes > kMaxFieldBytes || record.textBytes > kMaxFieldBytes) {
+        return false;
+    }
+
+    key.resize(record.keyBytes);
+    text.resize(record.textBytes);
+    const uint64_t keyOffset = offset + sizeof(record);
+    if ((record.keyBytes > 0 && !readFully(logFd_, &key[0], record.keyBytes, keyOffset)) ||
+        (record.textBytes > 0 && !readFully(logFd_, &text[0], record.textBytes, keyOffset + record.keyBytes))) {
+        return false;
+    }
+    if (fnv1a(text, fnv1a(key)) != record.checksum) {
+        return false;
+    }
+
+    next = keyOffset + record.keyBytes + record.textBytes;
+    return true;
+}
+
+void TranslationMemory::closeFiles() {
+    if (mapping_) {
+        msync(mapping_, mappingSize_, MS_SYNC);
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+    if (indexFd_ >= 0) {
+        ::close(indexFd_);
+        indexFd_ = -1;
+    }
+    if (logFd_ >= 0) {
+        fdatasync(logFd_);
+        ::close(logFd_);
+        logFd_ = -1;
+    }
+}
+
+TranslationMemory::IndexHeader* TranslationMemory::header() const {
+    return static_cast<IndexHeader*>(mapping_);
+}
+
+TranslationMemory::IndexSlot* TranslationMemory::slotTable() const {
+    return reinterpret_cast<IndexSlot*>(static_cast<char*>(mapping_) + sizeof(IndexHeader));
+}
+
+} // namespace translation
+} // namespace koebridge
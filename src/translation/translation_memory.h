@@ -0,0 +1,203 @@
+/**
+ * @file translation_memory.h
+ * @brief Persistent translation memory kept across sessions
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace koebridge {
+namespace translation {
+
+/**
+ * @struct TranslationMemoryStats
+ * @brief Counters reported by the translation memory
+ */
+struct TranslationMemoryStats {
+    uint64_t hits = 0;           ///< Lookups answered from disk
+    uint64_t misses = 0;         ///< Lookups that found nothing
+    uint64_t writes = 0;         ///< Entries appended to the log
+    uint64_t dropped = 0;        ///< Entries not written because the log is full
+    size_t entries = 0;          ///< Entries in the index
+    size_t logBytes = 0;         ///< Size of the log file
+    size_t pendingWrites = 0;    ///< Entries waiting for the writer thread
+};
+
+/**
+ * @class TranslationMemory
+ * @brief On-disk key to translation store: append-only log plus memory-mapped hash index
+ *
+ * Every entry is appended to a log file as a length-prefixed, checksummed record and
+ * never rewritten. A separate index file, mapped into memory, holds an open-addressing
+ * hash table from key hash to record offset, so a lookup costs a few probes in the
+ * mapping and one read of the record. Writes are queued and done by a background
+ * thread one record at a time, so a lookup never waits behind more than one append;
+ * a lookup of an entry still in the queue misses.
+ *
+ * The index records how much of the log it covers. On open, records past that point
+ * are indexed again and a torn record at the end of the log is cut off, so the store
+ * survives a crash between the two writes. A missing or damaged index is rebuilt from
+ * the log. Once the log reaches its size limit new entries are dropped.
+ */
+class TranslationMemory {
+public:
+    /**
+     * @brief Constructor for TranslationMemory
+     */
+    TranslationMemory();
+
+    /**
+     * @brief Destructor, writes the queued entries and closes the files
+     */
+    ~TranslationMemory();
+
+    TranslationMemory(const TranslationMemory&) = delete;
+    TranslationMemory& operator=(const TranslationMemory&) = delete;
+
+    /**
+     * @brief Open or create the memory in a directory and start the writer thread
+     * @param directory Directory holding memory.log and memory.idx, created if missing
+     * @param maxLogBytes Size limit of the log file
+     * @return bool True if the memory is ready
+     */
+    bool open(const std::string& directory, size_t maxLogBytes);
+
+    /**
+     * @brief Write the queued entries, stop the writer thread and close the files
+     */
+    void close();
+
+    /**
+     * @brief Check if the memory is open
+     * @return bool True if open
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Look up the translation stored for a key
+     * @param key Entry key
+     * @param text Receives the translation
+     * @return bool True if found
+     */
+    bool lookup(const std::string& key, std::string& text);
+
+    /**
+     * @brief Queue an entry for the writer thread
+     * @param key Entry key
+     * @param text Translation to store
+     */
+    void store(const std::string& key, const std::string& text);
+
+    /**
+     * @brief Wait until every queued entry has been written
+     */
+    void flush();
+
+    /**
+     * @brief Get the memory's counters
+     * @return TranslationMemoryStats Snapshot of the counters
+     */
+    TranslationMemoryStats getStats() const;
+
+private:
+    struct IndexHeader;
+    struct IndexSlot;
+
+    /**
+     * @brief Writer thread main loop
+     */
+    void writerLoop();
+
+    /**
+     * @brief Append one entry to the log and index it; requires mutex_
+     * @param key Entry key
+     * @param text Translation
+     * @return bool True if written
+     */
+    bool append(const std::string& key, const std::string& text);
+
+    /**
+     * @brief Map the index file, creating or rebuilding it if it is not usable; requires mutex_
+     * @param path Path to the index file
+     * @return bool True if the index is mapped
+     */
+    bool openIndex(const std::string& path);
+
+    /**
+     * @brief Create an empty index with a given number of slots and map it; requires mutex_
+     * @param capacity Number of slots, a power of two
+     * @return bool True if the index is mapped
+     */
+    bool createIndex(size_t capacity);
+
+    /**
+     * @brief Index the log records the index does not cover yet; requires mutex_
+     * @return bool True if the log could be read
+     */
+    bool catchUpIndex();
+
+    /**
+     * @brief Add a record to the index, growing it when it gets too full; requires mutex_
+     * @param key Key of the record, replaces an older record with the same key
+     * @param hash Key hash
+     * @param offset Offset of the record in the log
+     * @return bool True if indexed
+     */
+    bool indexRecord(const std::string& key, uint64_t hash, uint64_t offset);
+
+    /**
+     * @brief Double the index capacity and rehash every slot; requires mutex_
+     * @return bool True if the index grew
+     */
+    bool growIndex();
+
+    /**
+     * @brief Read the record at a log offset
+     * @param offset Offset of the record
+     * @param key Receives the key
+     * @param text Receives the translation
+     * @param next Receives the offset after the record
+     * @return bool True if a complete record with a valid checksum was read
+     */
+    bool readRecord(uint64_t offset, std::string& key, std::string& text, uint64_t& next) const;
+
+    /**
+     * @brief Unmap the index and close both files; requires mutex_
+     */
+    void closeFiles();
+
+    IndexHeader* header() const;
+    IndexSlot* slotTable() const;
+
+    std::string indexPath_;                    ///< Path to the index file
+    int logFd_ = -1;                           ///< Log file descriptor
+    int indexFd_ = -1;                         ///< Index file descriptor
+    void* mapping_ = nullptr;                  ///< Mapped index file
+    size_t mappingSize_ = 0;                   ///< Size of the mapping
+    size_t maxLogBytes_ = 0;                   ///< Log size limit
+    bool full_ = false;                        ///< Set once the log reached its limit
+
+    mutable std::mutex mutex_;                 ///< Guards the files, the mapping and the counters
+    uint64_t hits_ = 0;                        ///< Lookups answered
+    uint64_t misses_ = 0;                      ///< Lookups that found nothing
+    uint64_t writes_ = 0;                      ///< Entries appended
+    uint64_t dropped_ = 0;                     ///< Entries refused by the size limit
+
+    std::deque<std::pair<std::string, std::string>> writeQueue_; ///< Entries waiting to be written
+    bool writing_ = false;                     ///< The writer is working on a batch
+    bool stopping_ = false;                    ///< The writer exits once the queue is empty
+    mutable std::mutex queueMutex_;            ///< Guards writeQueue_, writing_ and stopping_
+    std::condition_variable queueCv_;          ///< Signals queued entries and finished batches
+    std::thread writer_;                       ///< Writer thread
+};
+
+} // namespace translation
+} // namespace koebridge
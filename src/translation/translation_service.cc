@@ -7,17 +7,28 @@
 #include "interfaces/i_translation_model.h"
 #include "utils/logger.h"
 #include "utils/config.h"
+#include "utils/text_normalizer.h"
 #include <QThread>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QtConcurrent>
+#include <QStandardPaths>
+#include <algorithm>
 
 namespace koebridge {
 namespace translation {
 
+namespace {
+
+// Meeting speech repeats mostly in short utterances, longer texts are not cached
+constexpr size_t kMaxCachedTextBytes = 512;
+
+} // namespace
+
 TranslationService::TranslationService(std::shared_ptr<IModelManager> modelManager)
     : modelManager_(std::move(modelManager))
-    , initialized_(false) {
+    , initialized_(false)
+    , cache_(static_cast<size_t>(std::max(0, utils::Config::getInstance().getInt("translation.cache_size", 4096)))) {
 
     // Initialize default options
     options_.temperature = 0.7f;
@@ -47,6 +58,20 @@ bool TranslationService::initialize() {
     // - Set up signal/slot connections for progress reporting
     // - Validate model availability
 
+    // Translations of earlier sessions; the service works without them
+    utils::Config& config = utils::Config::getInstance();
+    if (config.getBool("translation.memory_enabled", true)) {
+        std::string memoryPath = config.getString("translation.memory_path");
+        if (memoryPath.empty()) {
+            memoryPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString() +
+                         "/translation_memory";
+        }
+        const int maxMb = std::max(1, config.getInt("translation.memory_max_mb", 64));
+        if (!memory_.open(memoryPath, static_cast<size_t>(maxMb) * 1024 * 1024)) {
+            LOG_WARNING("Translation memory unavailable, continuing without it");
+        }
+    }
+
     initialized_ = true;
     return true;
 }
@@ -57,6 +82,18 @@ bool TranslationService::isInitialized() const {
 
 void TranslationService::shutdown() {
     initialized_ = false;
+    cancelPendingTranslations();
+
+    // Writes the translations still queued for disk
+    memory_.close();
+}
+
+void TranslationService::cancelPendingTranslations() {
+    // Running requests stop at their next decode step, queued ones never start
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    for (const auto& pending : pending_) {
+        pending->cancellation->cancel();
+    }
 }
 
 bool TranslationService::translate(const std::string& input, std::string& output) {
@@ -71,7 +108,7 @@ bool TranslationService::translate(const std::string& input, std::string& output
     }
 
     try {
-        auto result = translateInternal(input);
+        auto result = translateInternal(input, requestOptions());
         if (result.success) {
             output = result.text;
             emit translationComplete(QString::fromStdString(input),
@@ -99,7 +136,7 @@ std::string TranslationService::translateText(const std::string& japaneseText) {
     }
 
     try {
-        auto result = translateInternal(japaneseText);
+        auto result = translateInternal(japaneseText, requestOptions());
         if (result.success) {
             emit translationComplete(QString::fromStdString(japaneseText),
                                   QString::fromStdString(result.text));
@@ -114,52 +151,162 @@ std::string TranslationService::translateText(const std::string& japaneseText) {
     }
 }
 
-void TranslationService::translateTextAsync(const std::string& japaneseText, TranslationCallback callback) {
+std::shared_ptr<utils::CancellationToken> TranslationService::translateTextAsync(const std::string& japaneseText,
+                                                                               TranslationCallback callback) {
     if (!initialized_) {
         emit error("Translation service not initialized");
         callback(TranslationResult{});
-        return;
+        return nullptr;
     }
 
     if (!validateInput(japaneseText)) {
         emit error("Invalid input text");
         callback(TranslationResult{});
-        return;
+        return nullptr;
     }
 
     // TODO: Implement proper thread pool for better resource management
     // - Create a thread pool to limit concurrent translations
     // - Add prioritization for translation requests
-    // - Handle cancellation of pending requests
+
+    TranslationOptions options = requestOptions();
+    std::string key;
+    if (auto model = modelManager_->getTranslationModel()) {
+        key = cacheKey(japaneseText, options, model->getModelInfo());
+    }
+
+    // The caller cancels through the returned token, e.g. when a newer utterance supersedes this one
+    auto flight = std::make_shared<PendingTranslation>();
+    std::shared_ptr<utils::CancellationToken> token;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+
+        // An identical request already running delivers its result to this caller as well
+        if (!key.empty()) {
+            auto it = std::find_if(pending_.begin(), pending_.end(), [&key](const auto& pending) {
+                return pending->key == key && !pending->cancellation->shouldStop();
+            });
+            if (it != pending_.end()) {
+                std::lock_guard<std::mutex> flightLock((*it)->mutex);
+                ++coalescedRequests_;
+                return attachWaiter(*it, std::move(callback));
+            }
+        }
+
+        flight->key = key;
+        flight->cancellation = options.cancellation;
+        {
+            std::lock_guard<std::mutex> flightLock(flight->mutex);
+            token = attachWaiter(flight, std::move(callback));
+        }
+        pending_.push_back(flight);
+    }
 
     // Create a future watcher for async operation
     auto* watcher = new QFutureWatcher<TranslationResult>(this);
 
     // Connect signals
-    connect(watcher, &QFutureWatcher<TranslationResult>::finished, this, [this, watcher, callback, japaneseText]() {
+    connect(watcher, &QFutureWatcher<TranslationResult>::finished, this, [this, watcher, japaneseText, flight]() {
+        const std::vector<TranslationCallback> callbacks = releasePending(flight);
+        auto deliver = [&callbacks](const TranslationResult& result) {
+            for (const auto& callback : callbacks) {
+                callback(result);
+            }
+        };
+
         try {
             auto result = watcher->result();
-            if (result.success) {
+            if (result.partial && flight->cancellation->isCancelled()) {
+                // Cancelled on request, not an error; hand back what was translated
+                deliver(result);
+            } else if (result.success) {
                 emit translationComplete(QString::fromStdString(japaneseText),
                                       QString::fromStdString(result.text));
-                callback(result);
+                deliver(result);
             } else {
                 emit error(QString::fromStdString(result.errorMessage));
-                callback(TranslationResult{});
+                deliver(TranslationResult{});
             }
         } catch (const std::exception& e) {
             handleTranslationError(e.what());
-            callback(TranslationResult{});
+            deliver(TranslationResult{});
         }
         watcher->deleteLater();
     });
 
     // Start async operation
-    QFuture<TranslationResult> future = QtConcurrent::run([this, japaneseText]() {
-        return translateInternal(japaneseText);
+    QFuture<TranslationResult> future = QtConcurrent::run([this, japaneseText, options]() {
+        return translateInternal(japaneseText, options);
     });
 
     watcher->setFuture(future);
+    return token;
+}
+
+std::shared_ptr<utils::CancellationToken> TranslationService::attachWaiter(
+    const std::shared_ptr<PendingTranslation>& flight, TranslationCallback callback) {
+    const uint64_t id = flight->nextWaiterId++;
+    flight->waiters.push_back(PendingTranslation::Waiter{id, std::move(callback)});
+
+    // The token must not keep the translation alive, callers may hold it indefinitely
+    std::weak_ptr<PendingTranslation> weakFlight = flight;
+    return std::make_shared<utils::CancellationToken>(flight->cancellation->getDeadline(), [weakFlight, id] {
+        detachWaiter(weakFlight.lock(), id);
+    });
+}
+
+void TranslationService::detachWaiter(const std::shared_ptr<PendingTranslation>& flight, uint64_t id) {
+    if (!flight) {
+        return;
+    }
+
+    TranslationCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(flight->mutex);
+        auto it = std::find_if(flight->waiters.begin(), flight->waiters.end(), [id](const auto& waiter) {
+            return waiter.id == id;
+        });
+        if (it == flight->waiters.end()) {
+            return;  // already delivered
+        }
+
+        // The last caller keeps its callback to receive the partial result
+        if (flight->waiters.size() == 1) {
+            flight->cancellation->cancel();
+            return;
+        }
+        callback = std::move(it->callback);
+        flight->waiters.erase(it);
+    }
+
+    // The others keep the translation running, so this caller has no partial text to get
+    TranslationResult cancelled;
+    cancelled.success = false;
+    cancelled.partial = true;
+    cancelled.errorMessage = "Cancelled";
+    callback(cancelled);
+}
+
+std::vector<TranslationCallback> TranslationService::releasePending(const std::shared_ptr<PendingTranslation>& flight) {
+    // Callers that joined up to here get the result, later ones start a new translation
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pending_.erase(std::remove(pending_.begin(), pending_.end(), flight), pending_.end());
+    }
+
+    std::lock_guard<std::mutex> lock(flight->mutex);
+    std::vector<TranslationCallback> callbacks;
+    callbacks.reserve(flight->waiters.size());
+    for (auto& waiter : flight->waiters) {
+        callbacks.push_back(std::move(waiter.callback));
+    }
+    flight->waiters.clear();
+    return callbacks;
+}
+
+uint64_t TranslationService::getCoalescedRequests() const {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    return coalescedRequests_;
 }
 
 void TranslationService::setOptions(const TranslationOptions& options) {
@@ -178,7 +325,49 @@ TranslationOptions TranslationService::getTranslationOptions() const {
     return getOptions();
 }
 
-TranslationResult TranslationService::translateInternal(const std::string& japaneseText) {
+utils::CacheStats TranslationService::getCacheStats() const {
+    return cache_.getStats();
+}
+
+void TranslationService::clearCache() {
+    cache_.clear();
+}
+
+TranslationMemoryStats TranslationService::getMemoryStats() const {
+    return memory_.getStats();
+}
+
+std::string TranslationService::cacheKey(const std::string& text, const TranslationOptions& options,
+                                         const ModelInfo& model) {
+    if (text.size() > kMaxCachedTextBytes) {
+        return std::string();
+    }
+
+    const std::string& source = options.sourceLanguage.empty() ? model.sourceLanguage : options.sourceLanguage;
+    const std::string& target = options.targetLanguage.empty() ? model.targetLanguage : options.targetLanguage;
+
+    // Fields are separated by a control character that never occurs in them
+    std::string key = utils::normalizeWhitespace(text);
+    for (const std::string& field : {model.id, source, target}) {
+        key += '\x1f';
+        key += field;
+    }
+    key += '\x1f' + std::to_string(static_cast<int>(options.style)) +
+           '\x1f' + std::to_string(options.temperature) +
+           '\x1f' + std::to_string(options.maxLength) +
+           '\x1f' + std::to_string(options.beamSize);
+    return key;
+}
+
+TranslationOptions TranslationService::requestOptions() const {
+    // options_ is a template shared by all requests, each request gets its own token
+    TranslationOptions options = options_;
+    options.cancellation = utils::CancellationToken::withTimeout(options_.timeoutMs);
+    return options;
+}
+
+TranslationResult TranslationService::translateInternal(const std::string& japaneseText,
+                                                        const TranslationOptions& options) {
     TranslationResult result;
     result.sourceText = japaneseText;
 
@@ -194,11 +383,34 @@ TranslationResult TranslationService::translateInternal(const std::string& japan
         // TODO: Implement advanced translation features
         // - Add pre-processing for Japanese text (normalize, segment)
         // - Add post-processing for English text (capitalization, formatting)
-        // - Add caching of frequent translations
         // - Add statistics collection for translation quality monitoring
 
+        // Repeated utterances are answered without running the model
+        const std::string key = cacheKey(japaneseText, options, model->getModelInfo());
+        if (!key.empty() && cache_.get(key, result)) {
+            result.sourceText = japaneseText;
+            result.cached = true;
+            result.metrics = {};
+            return result;
+        }
+
+        // Then phrases from earlier sessions, promoted into the in-memory cache
+        if (!key.empty() && memory_.lookup(key, result.text)) {
+            result.success = true;
+            result.cached = true;
+            cache_.put(key, result);
+            return result;
+        }
+
         // Use the model to translate the text
-        return model->translate(japaneseText, options_);
+        result = model->translate(japaneseText, options);
+
+        // Only complete translations are reused, the disk write happens in the background
+        if (!key.empty() && result.success && !result.partial) {
+            cache_.put(key, result);
+            memory_.store(key, result.text);
+        }
+        return result;
     } catch (const std::exception& e) {
         result.success = false;
         result.errorMessage = std::string("Translation error: ") + e.what();
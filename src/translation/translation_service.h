@@ -8,9 +8,13 @@
 #include <memory>
 #include <string>
 #include <functional>
+#include <mutex>
+#include <vector>
 #include <QObject>
 #include <QString>
 #include "data_structures.h"
+#include "translation_memory.h"
+#include "utils/sharded_lru_cache.h"
 #include "interfaces/i_translation_service.h"
 #include "interfaces/i_model_manager.h"
 
@@ -52,7 +56,45 @@ public:
     // Additional methods not in the interface
     void shutdown();
     std::string translateText(const std::string& japaneseText);
-    void translateTextAsync(const std::string& japaneseText, TranslationCallback callback);
+    /**
+     * @brief Translate text on a worker thread and report the result to a callback
+     *
+     * While a request for the same cache key is running, the callback joins it instead
+     * of starting another inference, and receives the same result. Every caller gets its
+     * own token: cancelling it drops that caller's callback, and the shared translation
+     * only stops once every caller attached to it has cancelled. The last caller to
+     * cancel receives the partial result. A request that has stopped is not joined.
+     *
+     * @param japaneseText Text to translate
+     * @param callback Receives the result on the service's thread
+     * @return std::shared_ptr<utils::CancellationToken> Token cancelling the translation, null if rejected
+     */
+    std::shared_ptr<utils::CancellationToken> translateTextAsync(const std::string& japaneseText,
+                                                                 TranslationCallback callback);
+    void cancelPendingTranslations();
+
+    /**
+     * @brief Get the hit, miss and size counters of the translation cache
+     * @return utils::CacheStats Snapshot of the cache counters
+     */
+    utils::CacheStats getCacheStats() const;
+
+    /**
+     * @brief Drop all cached translations
+     */
+    void clearCache();
+
+    /**
+     * @brief Get the number of asynchronous requests served by an identical running request
+     * @return uint64_t Requests that did not start an inference of their own
+     */
+    uint64_t getCoalescedRequests() const;
+
+    /**
+     * @brief Get the counters of the on-disk translation memory
+     * @return TranslationMemoryStats Snapshot of the memory counters
+     */
+    TranslationMemoryStats getMemoryStats() const;
     void setTranslationOptions(const TranslationOptions& options);
     TranslationOptions getTranslationOptions() const;
 
@@ -77,12 +119,80 @@ signals:
     void progressUpdated(int progress);
 
 private:
+    /**
+     * @struct PendingTranslation
+     * @brief An asynchronous translation in progress and the callers waiting for it
+     */
+    struct PendingTranslation {
+        /**
+         * @struct Waiter
+         * @brief A caller attached to the translation
+         */
+        struct Waiter {
+            uint64_t id;                                    ///< Identifies the caller within the translation
+            TranslationCallback callback;                   ///< Receives the result
+        };
+
+        std::string key;                                    ///< Cache key, empty if it cannot be shared
+        std::shared_ptr<utils::CancellationToken> cancellation; ///< Passed to the model, fires once every caller cancelled
+        std::vector<Waiter> waiters;                        ///< Callers that have not cancelled
+        uint64_t nextWaiterId = 0;                          ///< ID of the next caller to attach
+        std::mutex mutex;                                   ///< Guards waiters and nextWaiterId
+    };
+
     /**
      * @brief Internal translation function
      * @param japaneseText The Japanese text to translate
+     * @param options Options of this request
      * @return TranslationResult The translation result
      */
-    TranslationResult translateInternal(const std::string& japaneseText);
+    TranslationResult translateInternal(const std::string& japaneseText, const TranslationOptions& options);
+
+    /**
+     * @brief Build the cache key of a request
+     *
+     * Covers the whitespace-normalized text, the model, the language pair and the
+     * options that change the output. Empty languages resolve to the model's.
+     *
+     * @param text Source text
+     * @param options Options of the request
+     * @param model Model the request runs on
+     * @return std::string The key, empty if the text is too long to be worth caching
+     */
+    static std::string cacheKey(const std::string& text, const TranslationOptions& options, const ModelInfo& model);
+
+    /**
+     * @brief Copy the current options with a fresh cancellation token for one request
+     * @return TranslationOptions Options whose token expires after timeoutMs
+     */
+    TranslationOptions requestOptions() const;
+
+    /**
+     * @brief Attach a caller to a translation and create the caller's own token; requires flight->mutex
+     * @param flight The translation
+     * @param callback Receives the result
+     * @return std::shared_ptr<utils::CancellationToken> Token that detaches the caller when cancelled
+     */
+    static std::shared_ptr<utils::CancellationToken> attachWaiter(const std::shared_ptr<PendingTranslation>& flight,
+                                                                  TranslationCallback callback);
+
+    /**
+     * @brief Detach a caller that cancelled, cancelling the translation if it was the last one
+     *
+     * A caller detached while others keep waiting gets a cancelled result right away, on
+     * the thread that cancelled; the last one gets the partial result once decoding stops.
+     *
+     * @param flight The translation, null if it is already gone
+     * @param id ID of the caller
+     */
+    static void detachWaiter(const std::shared_ptr<PendingTranslation>& flight, uint64_t id);
+
+    /**
+     * @brief Stop tracking an asynchronous request that finished
+     * @param flight The finished request
+     * @return std::vector<TranslationCallback> Callers waiting for its result
+     */
+    std::vector<TranslationCallback> releasePending(const std::shared_ptr<PendingTranslation>& flight);
 
     bool validateInput(const std::string& input) const;
     void handleTranslationError(const std::string& message);
@@ -91,6 +201,11 @@ private:
     std::shared_ptr<IModelManager> modelManager_;  ///< Model manager instance
     TranslationOptions options_;                  ///< Current translation options
     bool initialized_;                            ///< Initialization state
+    std::vector<std::shared_ptr<PendingTranslation>> pending_; ///< Running asynchronous requests, few at a time
+    uint64_t coalescedRequests_ = 0;              ///< Requests that joined a running one
+    mutable std::mutex pendingMutex_;             ///< Guards pending_ and coalescedRequests_, taken before a flight's mutex
+    utils::ShardedLruCache<std::string, TranslationResult> cache_; ///< Recent successful translations
+    TranslationMemory memory_;                    ///< Translations kept across sessions
 };
 
 } // namespace translation
@@ -4,8 +4,8 @@
 namespace koebridge {
 namespace translation {
 
-TranslationWorker::TranslationWorker(std::shared_ptr<ITranslationModel> model)
-    : model_(model), running_(false) {
+TranslationWorker::TranslationWorker(std::shared_ptr<ITranslationModel> model, size_t numThreads)
+    : model_(model), numThreads_(numThreads == 0 ? 1 : numThreads), running_(false) {
 }
 
 TranslationWorker::~TranslationWorker() {
@@ -18,7 +18,9 @@ void TranslationWorker::start() {
     }
 
     running_ = true;
-    workerThread_ = std::thread(&TranslationWorker::processRequests, this);
+    for (size_t i = 0; i < numThreads_; ++i) {
+        workerThreads_.emplace_back(&TranslationWorker::processRequests, this);
+    }
 }
 
 void TranslationWorker::stop() {
@@ -32,9 +34,12 @@ void TranslationWorker::stop() {
     }
     queueCondition_.notify_all();
 
-    if (workerThread_.joinable()) {
-        workerThread_.join();
+    for (auto& thread : workerThreads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
     }
+    workerThreads_.clear();
 }
 
 void TranslationWorker::addRequest(const std::string& text, const TranslationOptions& options, TranslationCallback callback) {
@@ -12,6 +12,7 @@
 #include <condition_variable>
 #include <thread>
 #include <functional>
+#include <vector>
 #include "interfaces/i_translation_model.h"
 #include "translation/data_structures.h"
 
@@ -38,16 +39,19 @@ struct TranslationRequest {
  * @class TranslationWorker
  * @brief Worker class for handling translation requests in a separate thread
  *
- * This class manages translation requests in a background thread, providing
- * asynchronous translation capabilities and progress reporting.
+ * This class manages translation requests in background threads, providing
+ * asynchronous translation capabilities and progress reporting. With more than
+ * one thread, requests reach the model concurrently so a batching model can
+ * decode them together.
  */
 class TranslationWorker {
 public:
     /**
      * @brief Constructor for TranslationWorker
      * @param model Shared pointer to the translation model
+     * @param numThreads Number of requests handed to the model concurrently
      */
-    explicit TranslationWorker(std::shared_ptr<ITranslationModel> model);
+    explicit TranslationWorker(std::shared_ptr<ITranslationModel> model, size_t numThreads = 1);
 
     /**
      * @brief Destructor for TranslationWorker
@@ -82,7 +86,8 @@ private:
     std::queue<TranslationRequest> requestQueue_;  ///< Queue of translation requests
     std::mutex queueMutex_;                        ///< Mutex for queue access
     std::condition_variable queueCondition_;       ///< Condition variable for queue
-    std::thread workerThread_;                     ///< Worker thread
+    std::vector<std::thread> workerThreads_;       ///< Worker threads
+    size_t numThreads_;                            ///< Number of worker threads
     bool running_ = false;                         ///< Worker running flag
 };
 
@@ -0,0 +1,126 @@
+/**
+ * @file cancellation_token.h
+ * @brief Cancellation flag and deadline shared by everything working on one request
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace koebridge {
+namespace utils {
+
+/**
+ * @class CancellationToken
+ * @brief Tells long-running work on a request that it should stop
+ *
+ * The caller keeps a shared pointer to cancel the request; every stage working on it
+ * (queues, the decode loop) polls shouldStop() at its own safe points and winds down
+ * with whatever it has produced so far. Polling is one atomic load and, with a
+ * deadline, one clock read.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructor for CancellationToken without a deadline
+     */
+    CancellationToken() = default;
+
+    /**
+     * @brief Constructor for CancellationToken
+     * @param deadline Point in time after which the request expires
+     */
+    explicit CancellationToken(Clock::time_point deadline)
+        : deadline_(deadline) {
+    }
+
+    /**
+     * @brief Constructor for CancellationToken that reports when it is cancelled
+     * @param deadline Point in time after which the request expires
+     * @param onCancel Called once, on the thread of the first cancel() call
+     */
+    CancellationToken(Clock::time_point deadline, std::function<void()> onCancel)
+        : deadline_(deadline), onCancel_(std::move(onCancel)) {
+    }
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    /**
+     * @brief Create a token that expires a number of milliseconds from now
+     * @param timeoutMs Time budget, 0 or less for no deadline
+     * @return std::shared_ptr<CancellationToken> The new token
+     */
+    static std::shared_ptr<CancellationToken> withTimeout(int timeoutMs) {
+        if (timeoutMs <= 0) {
+            return std::make_shared<CancellationToken>();
+        }
+        return std::make_shared<CancellationToken>(Clock::now() + std::chrono::milliseconds(timeoutMs));
+    }
+
+    /**
+     * @brief Cancel the request, for instance because a newer one superseded it
+     */
+    void cancel() {
+        if (!cancelled_.exchange(true, std::memory_order_relaxed) && onCancel_) {
+            onCancel_();
+        }
+    }
+
+    /**
+     * @brief Check if cancel() was called
+     * @return bool True if cancelled
+     */
+    bool isCancelled() const {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check if the deadline has passed
+     * @return bool True if expired
+     */
+    bool isExpired() const {
+        return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_;
+    }
+
+    /**
+     * @brief Check if work on the request should stop
+     * @return bool True if cancelled or expired
+     */
+    bool shouldStop() const {
+        return isCancelled() || isExpired();
+    }
+
+    /**
+     * @brief Describe why work on the request stopped
+     * @return const char* "Cancelled", "Deadline exceeded" or an empty string
+     */
+    const char* stopReason() const {
+        if (isCancelled()) {
+            return "Cancelled";
+        }
+        return isExpired() ? "Deadline exceeded" : "";
+    }
+
+    /**
+     * @brief Get the deadline
+     * @return Clock::time_point The deadline, time_point::max() if there is none
+     */
+    Clock::time_point getDeadline() const {
+        return deadline_;
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};            ///< Set by cancel()
+    const Clock::time_point deadline_ = Clock::time_point::max(); ///< Expiry time
+    const std::function<void()> onCancel_;          ///< Run by the first cancel(), may be empty
+};
+
+} // namespace utils
+} // namespace koebridge
@@ -0,0 +1,82 @@
+/**
+ * @file random.h
+ * @brief Small, fast pseudo-random number generator for per-request use
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace koebridge {
+namespace utils {
+
+/**
+ * @class Xoshiro256
+ * @brief xoshiro256** generator seeded through splitmix64
+ *
+ * The state is 32 bytes and owned by the caller, so every request can carry its own
+ * generator: no shared libc state, no locking, and a given seed always reproduces
+ * the same sequence.
+ */
+class Xoshiro256 {
+public:
+    /**
+     * @brief Constructor for Xoshiro256
+     * @param seed Seed expanded into the full generator state
+     */
+    explicit Xoshiro256(uint64_t seed) {
+        for (uint64_t& word : state_) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    /**
+     * @brief Draw the next 64 random bits
+     * @return uint64_t Random value
+     */
+    uint64_t next() {
+        const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+
+        return result;
+    }
+
+    /**
+     * @brief Draw a uniform float
+     * @return float Random value in [0, 1)
+     */
+    float nextFloat() {
+        return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    /**
+     * @brief Pick a seed from the system entropy source
+     * @return uint64_t A fresh seed
+     */
+    static uint64_t randomSeed() {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t state_[4];                ///< Generator state
+};
+
+} // namespace utils
+} // namespace koebridge
@@ -0,0 +1,218 @@
+/**
+ * @file sharded_lru_cache.h
+ * @brief Thread-safe bounded LRU cache split into independently locked shards
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace koebridge {
+namespace utils {
+
+/**
+ * @struct CacheStats
+ * @brief Counters reported by a cache
+ */
+struct CacheStats {
+    uint64_t hits = 0;       ///< Lookups answered from the cache
+    uint64_t misses = 0;     ///< Lookups that found nothing
+    uint64_t evictions = 0;  ///< Entries dropped to stay within capacity
+    size_t size = 0;         ///< Entries currently held
+    size_t capacity = 0;     ///< Maximum number of entries
+
+    /**
+     * @brief Fraction of lookups answered from the cache
+     * @return double Hit rate in [0, 1], 0 before the first lookup
+     */
+    double hitRate() const {
+        const uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+/**
+ * @class ShardedLruCache
+ * @brief Bounded least-recently-used cache for concurrent lookups
+ *
+ * Keys are spread over a fixed number of shards by hash, each with its own mutex,
+ * list and index, so threads looking up different keys rarely contend. Every shard
+ * evicts its own least recently used entry once it holds capacity / shards entries.
+ *
+ * @tparam Key Key type
+ * @tparam Value Value type, copied out on a hit
+ * @tparam Hash Hash function for Key
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+    static constexpr size_t kShardCount = 16;  ///< Number of independently locked shards
+
+    /**
+     * @brief Constructor for ShardedLruCache
+     * @param capacity Maximum number of entries, 0 disables the cache
+     */
+    explicit ShardedLruCache(size_t capacity) {
+        setCapacity(capacity);
+    }
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+    /**
+     * @brief Look up a key and mark it as most recently used
+     * @param key Key to look up
+     * @param value Receives a copy of the cached value on a hit
+     * @return bool True if the key was cached
+     */
+    bool get(const Key& key, Value& value) {
+        Shard& shard = shardFor(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(key);
+            if (it != shard.index.end()) {
+                shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+                value = it->second->second;
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Insert or replace an entry, evicting the shard's oldest entry if it is full
+     * @param key Key to store
+     * @param value Value to store
+     */
+    void put(const Key& key, Value value) {
+        const size_t limit = shardCapacity_.load(std::memory_order_relaxed);
+        if (limit == 0) {
+            return;
+        }
+
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->second = std::move(value);
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            return;
+        }
+
+        while (shard.entries.size() >= limit) {
+            shard.index.erase(shard.entries.back().first);
+            shard.entries.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.entries.emplace_front(key, std::move(value));
+        shard.index.emplace(key, shard.entries.begin());
+    }
+
+    /**
+     * @brief Remove an entry
+     * @param key Key to remove
+     * @return bool True if the key was cached
+     */
+    bool erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return false;
+        }
+        shard.entries.erase(it->second);
+        shard.index.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Remove all entries, keeping the counters
+     */
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            shard.index.clear();
+        }
+    }
+
+    /**
+     * @brief Change the maximum number of entries
+     *
+     * Shards above the new limit shrink on their next insertion.
+     *
+     * @param capacity Maximum number of entries, 0 disables the cache
+     */
+    void setCapacity(size_t capacity) {
+        capacity_.store(capacity, std::memory_order_relaxed);
+        shardCapacity_.store(capacity ? (capacity + kShardCount - 1) / kShardCount : 0,
+                             std::memory_order_relaxed);
+        if (capacity == 0) {
+            clear();
+        }
+    }
+
+    /**
+     * @brief Get the hit, miss and size counters
+     * @return CacheStats Snapshot of the counters
+     */
+    CacheStats getStats() const {
+        CacheStats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.capacity = capacity_.load(std::memory_order_relaxed);
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.size += shard.entries.size();
+        }
+        return stats;
+    }
+
+    /**
+     * @brief Reset the hit, miss and eviction counters
+     */
+    void resetStats() {
+        hits_.store(0, std::memory_order_relaxed);
+        misses_.store(0, std::memory_order_relaxed);
+        evictions_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;  // most recently used first
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+    };
+
+    Shard& shardFor(const Key& key) {
+        // Mix the hash so shard selection does not reuse the buckets' low bits
+        uint64_t h = static_cast<uint64_t>(Hash{}(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return shards_[h % kShardCount];
+    }
+
+    std::array<Shard, kShardCount> shards_;
+    std::atomic<size_t> capacity_{0};
+    std::atomic<size_t> shardCapacity_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
+
+} // namespace utils
+} // namespace koebridge
@@ -0,0 +1,51 @@
+/**
+ * @file text_normalizer.cc
+ * @brief Implementation of the text normalization helpers
+ */
+
+#include "utils/text_normalizer.h"
+
+namespace koebridge {
+namespace utils {
+
+namespace {
+
+// UTF-8 encoding of U+3000 IDEOGRAPHIC SPACE
+constexpr char kIdeographicSpace[] = "\xE3\x80\x80";
+
+// Length of the whitespace sequence starting at pos, 0 if there is none
+size_t whitespaceLength(const std::string& text, size_t pos) {
+    switch (text[pos]) {
+        case ' ': case '\t': case '\n': case '\r': case '\f': case '\v':
+            return 1;
+        default:
+            return text.compare(pos, 3, kIdeographicSpace) == 0 ? 3 : 0;
+    }
+}
+
+} // namespace
+
+std::string normalizeWhitespace(const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+
+    bool pendingSpace = false;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const size_t length = whitespaceLength(text, pos);
+        if (length > 0) {
+            pendingSpace = !normalized.empty();
+            pos += length;
+            continue;
+        }
+        if (pendingSpace) {
+            normalized += ' ';
+            pendingSpace = false;
+        }
+        normalized += text[pos++];
+    }
+    return normalized;
+}
+
+} // namespace utils
+} // namespace koebridge
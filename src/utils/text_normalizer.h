@@ -0,0 +1,26 @@
+/**
+ * @file text_normalizer.h
+ * @brief Text normalization shared by the caches
+ */
+
+#pragma once
+
+#include <string>
+
+namespace koebridge {
+namespace utils {
+
+/**
+ * @brief Trim text and collapse whitespace runs into single spaces
+ *
+ * ASCII whitespace and the ideographic space U+3000 count as whitespace. SentencePiece's
+ * default normalizer does the same, so texts with the same normalized form tokenize
+ * identically and can share cache entries.
+ *
+ * @param text Input text, UTF-8
+ * @return std::string Normalized text
+ */
+std::string normalizeWhitespace(const std::string& text);
+
+} // namespace utils
+} // namespace koebridge
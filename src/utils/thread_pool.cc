@@ -0,0 +1,148 @@
+/**
+ * @file thread_pool.cc
+ * @brief Implementation of the shared work-stealing thread pool
+ */
+
+#include "utils/thread_pool.h"
+#include "utils/config.h"
+#include <algorithm>
+
+namespace koebridge {
+namespace utils {
+
+namespace {
+
+// Identifies the pool and deque of the current worker thread
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    numThreads = std::max<size_t>(1, numThreads);
+    queues_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    workers_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    sleepCv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::shared() {
+    static std::shared_ptr<ThreadPool> pool = [] {
+        Config& config = Config::getInstance();
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        const int computeThreads = std::max(1, config.getInt("inference.num_threads", 4));
+        const int defaultThreads = std::max(2, cores - computeThreads);
+        const int threads = config.getInt("inference.async_threads", defaultThreads);
+        return std::make_shared<ThreadPool>(static_cast<size_t>(std::max(1, threads)));
+    }();
+    return pool;
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers_.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    const size_t index = currentPool == this
+        ? currentWorker
+        : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1);
+
+    // Only wake a worker if one is going to sleep. Taking the mutex orders this with
+    // its check of pending_, so the notification cannot slip in before it waits.
+    if (sleepers_.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        sleepCv_.notify_one();
+    }
+}
+
+bool ThreadPool::reserveTask() {
+    size_t available = pending_.load();
+    while (available > 0) {
+        if (pending_.compare_exchange_weak(available, available - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::takeTask(size_t index, std::function<void()>& task) {
+    // Own deque first, newest task while it is still warm
+    {
+        WorkerQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Then steal the oldest task of the other workers
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        WorkerQueue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        if (!reserveTask()) {
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            ++sleepers_;
+            sleepCv_.wait(lock, [this] {
+                return pending_.load() > 0 || stopping_;
+            });
+            --sleepers_;
+            if (stopping_ && pending_.load() == 0) {
+                break;  // stopping with nothing left to run
+            }
+            continue;
+        }
+
+        // A task is reserved for this worker, but another worker may have taken it and
+        // left a newer one in a deque this scan already passed, so scan again
+        std::function<void()> task;
+        while (!takeTask(index, task)) {
+            std::this_thread::yield();
+        }
+
+        // packaged_task stores exceptions in the future
+        task();
+    }
+}
+
+} // namespace utils
+} // namespace koebridge
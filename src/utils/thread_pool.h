@@ -0,0 +1,126 @@
+/**
+ * @file thread_pool.h
+ * @brief Shared work-stealing thread pool for asynchronous model calls
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace koebridge {
+namespace utils {
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads that steal work from each other
+ *
+ * Every worker owns a task deque. Tasks submitted from outside are spread over the
+ * deques round robin, tasks submitted by a worker go to its own deque. A worker
+ * takes its newest task first and, once its deque is empty, steals the oldest task
+ * of another worker, so a burst on one deque is shared out without a global queue
+ * lock: the queued task count is atomic, and the sleep mutex is only taken by workers
+ * going idle and by submitters that have to wake one. The worker count bounds how
+ * many tasks run at once.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor for ThreadPool, starts the workers
+     * @param numThreads Number of worker threads
+     */
+    explicit ThreadPool(size_t numThreads);
+
+    /**
+     * @brief Destructor, runs the remaining tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the process-wide pool shared by the models
+     *
+     * Sized by inference.async_threads. By default it uses the cores left over by
+     * ggml's compute threads (inference.num_threads), and at least two.
+     *
+     * @return std::shared_ptr<ThreadPool> The shared pool
+     */
+    static std::shared_ptr<ThreadPool> shared();
+
+    /**
+     * @brief Run a callable on the pool
+     * @param fn Callable taking no arguments
+     * @return std::future Future for the callable's result or exception
+     */
+    template <typename Fn>
+    auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>> {
+        using Result = std::invoke_result_t<std::decay_t<Fn>>;
+        // std::function needs a copyable target, the task itself is move-only
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    /**
+     * @brief Get the number of worker threads
+     * @return size_t Worker count
+     */
+    size_t getThreadCount() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    /**
+     * @brief Add a task to a worker's deque and wake a sleeping worker
+     * @param task Task to run
+     */
+    void enqueue(std::function<void()> task);
+
+    /**
+     * @brief Claim one queued task for the calling worker without locking
+     * @return bool True if a task was reserved, false if none is queued
+     */
+    bool reserveTask();
+
+    /**
+     * @brief Take the next task for a worker, stealing if its own deque is empty
+     * @param index Worker index
+     * @param task Receives the task
+     * @return bool True if a task was taken
+     */
+    bool takeTask(size_t index, std::function<void()>& task);
+
+    /**
+     * @brief Worker thread main loop
+     * @param index Worker index
+     */
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_; ///< One task deque per worker
+    std::vector<std::thread> workers_;         ///< Worker threads
+    std::atomic<size_t> nextQueue_{0};         ///< Round-robin target for outside submissions
+    std::atomic<size_t> pending_{0};           ///< Queued tasks over all deques not yet reserved by a worker
+    std::atomic<size_t> sleepers_{0};          ///< Workers on the sleep path
+    std::mutex sleepMutex_;                    ///< Guards stopping_ and the sleep/wake handshake
+    std::condition_variable sleepCv_;          ///< Wakes idle workers
+    bool stopping_ = false;                    ///< Workers exit once set and no task is left
+};
+
+} // namespace utils
+} // namespace koebridge
@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "inference/batch_scheduler.h"
+#include "inference/engine.h"
+#include "one_hot_model.h"
+
+namespace fs = std::filesystem;
+
+namespace koebridge {
+namespace inference {
+namespace testing {
+
+class BatchSchedulerTest : public ::testing::Test {
+protected:
+    static constexpr int kVocabSize = 64;
+
+    void SetUp() override {
+        path_ = fs::temp_directory_path() / "batch_scheduler_test.gguf";
+        ASSERT_TRUE(writeOneHotModel(path_.string(), oneHotVocabulary(kVocabSize)));
+        ASSERT_TRUE(engine_.initialize(path_.string()));
+    }
+
+    void TearDown() override {
+        fs::remove(path_);
+    }
+
+    static std::shared_ptr<const std::vector<int>> tokenRange(int first, int last) {
+        auto shortlist = std::make_shared<std::vector<int>>(last - first);
+        std::iota(shortlist->begin(), shortlist->end(), first);
+        return shortlist;
+    }
+
+    fs::path path_;
+    InferenceEngine engine_;
+};
+
+TEST_F(BatchSchedulerTest, RowsSampleOnlyTheirOwnShortlist) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    // The first sequence waits after its first token until the second one is queued,
+    // so the second one's every step shares a forward pass with the first
+    std::promise<void> secondQueued;
+    std::shared_future<void> queued = secondQueued.get_future().share();
+
+    SequenceRequest first;
+    first.promptTokens = {1, 12};
+    first.maxNewTokens = 6;
+    first.eosToken = -1;
+    first.shortlist = tokenRange(10, 20);
+    first.onToken = [queued](int) {
+        queued.wait();
+        return true;
+    };
+
+    // Ends on a token of the first shortlist, which wins over the union
+    SequenceRequest second;
+    second.promptTokens = {1, 15};
+    second.maxNewTokens = 4;
+    second.eosToken = -1;
+    second.shortlist = tokenRange(30, 50);
+
+    auto firstResult = scheduler.submit(first);
+    auto secondResult = scheduler.submit(second);
+    secondQueued.set_value();
+
+    SequenceResult a = firstResult.get();
+    SequenceResult b = secondResult.get();
+    ASSERT_TRUE(a.success);
+    ASSERT_TRUE(b.success);
+
+    for (size_t i = first.promptTokens.size(); i < a.tokens.size(); ++i) {
+        EXPECT_GE(a.tokens[i], 10) << i;
+        EXPECT_LT(a.tokens[i], 20) << i;
+    }
+    ASSERT_EQ(b.tokens.size(), second.promptTokens.size() + 4);
+    for (size_t i = second.promptTokens.size(); i < b.tokens.size(); ++i) {
+        EXPECT_GE(b.tokens[i], 30) << i;
+        EXPECT_LT(b.tokens[i], 50) << i;
+    }
+
+    SchedulerStats stats = scheduler.getStats();
+    EXPECT_GT(stats.rowsDecoded, stats.decodeSteps);
+}
+
+TEST_F(BatchSchedulerTest, ShortlistHoldsNextToUnrestrictedSequence) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    // The unrestricted sequence waits after its first token until the other one is
+    // queued, so the shortlisted one only ever runs in full-vocabulary passes
+    std::promise<void> shortlistedQueued;
+    std::shared_future<void> queued = shortlistedQueued.get_future().share();
+
+    SequenceRequest unrestricted;
+    unrestricted.promptTokens = {1, 15};
+    unrestricted.maxNewTokens = 6;
+    unrestricted.eosToken = -1;
+    unrestricted.onToken = [queued](int) {
+        queued.wait();
+        return true;
+    };
+
+    // Ends on a token outside its shortlist, which wins over the full vocabulary
+    SequenceRequest shortlisted;
+    shortlisted.promptTokens = {1, 40};
+    shortlisted.maxNewTokens = 4;
+    shortlisted.eosToken = -1;
+    shortlisted.shortlist = tokenRange(10, 20);
+
+    auto unrestrictedResult = scheduler.submit(unrestricted);
+    auto shortlistedResult = scheduler.submit(shortlisted);
+    shortlistedQueued.set_value();
+
+    SequenceResult a = unrestrictedResult.get();
+    SequenceResult b = shortlistedResult.get();
+    ASSERT_TRUE(a.success);
+    ASSERT_TRUE(b.success);
+
+    // The unrestricted sequence keeps its own argmax, the shortlisted one stays inside its list
+    for (size_t i = unrestricted.promptTokens.size(); i < a.tokens.size(); ++i) {
+        EXPECT_EQ(a.tokens[i], 15) << i;
+    }
+    ASSERT_EQ(b.tokens.size(), shortlisted.promptTokens.size() + 4);
+    for (size_t i = shortlisted.promptTokens.size(); i < b.tokens.size(); ++i) {
+        EXPECT_GE(b.tokens[i], 10) << i;
+        EXPECT_LT(b.tokens[i], 20) << i;
+    }
+    EXPECT_GT(scheduler.getStats().rowsDecoded, scheduler.getStats().decodeSteps);
+}
+
+TEST_F(BatchSchedulerTest, SubmitAllSharesEveryDecodeStep) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    std::vector<SequenceRequest> requests(3);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        requests[i].promptTokens = {1, 10 + static_cast<int>(i)};
+        requests[i].maxNewTokens = 3;
+        requests[i].eosToken = -1;
+    }
+
+    auto futures = scheduler.submitAll(requests);
+    ASSERT_EQ(futures.size(), requests.size());
+    for (size_t i = 0; i < futures.size(); ++i) {
+        SequenceResult result = futures[i].get();
+        ASSERT_TRUE(result.success) << i;
+        EXPECT_EQ(result.tokens, std::vector<int>({1, 10 + static_cast<int>(i), 10 + static_cast<int>(i),
+                                                   10 + static_cast<int>(i), 10 + static_cast<int>(i)})) << i;
+    }
+
+    // Admitted together, the sequences never decode alone
+    SchedulerStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.decodeSteps, 3u);
+    EXPECT_EQ(stats.rowsDecoded, 9u);
+}
+
+TEST_F(BatchSchedulerTest, OnCompleteReceivesTheResult) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    std::promise<SequenceResult> completed;
+    SequenceRequest request;
+    request.promptTokens = {1, 12};
+    request.maxNewTokens = 2;
+    request.eosToken = -1;
+    request.onComplete = [&completed](SequenceResult result) {
+        completed.set_value(std::move(result));
+    };
+    scheduler.submit(request);
+
+    SequenceResult result = completed.get_future().get();
+    ASSERT_TRUE(result.success);
+    EXPECT_EQ(result.tokens, std::vector<int>({1, 12, 12, 12}));
+}
+
+TEST_F(BatchSchedulerTest, DraftTokensAreAcceptedUpToTheFirstMismatch) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    // The one-hot model continues 12 with 12, so the proposal is right up to the 30
+    std::vector<size_t> budgets;
+    auto draft = std::make_shared<const DraftProposer>(
+        [&budgets](const std::vector<const std::vector<int>*>& histories, const std::vector<int>& maxTokens) {
+            budgets.insert(budgets.end(), maxTokens.begin(), maxTokens.end());
+            return std::vector<std::vector<int>>(histories.size(), std::vector<int>{12, 12, 30, 12});
+        });
+
+    SequenceRequest request;
+    request.promptTokens = {1, 12};
+    request.maxNewTokens = 6;
+    request.eosToken = -1;
+    request.draft = draft;
+    request.draftTokens = 4;
+
+    SequenceResult result = scheduler.submit(request).get();
+    ASSERT_TRUE(result.success);
+
+    // Step one accepts 12, 12 and samples 12 over the 30; step two has room for two
+    // more proposed tokens, accepts both and samples the last token
+    EXPECT_EQ(result.tokens, std::vector<int>({1, 12, 12, 12, 12, 12, 12, 12}));
+    EXPECT_EQ(budgets, std::vector<size_t>({4, 2}));
+    EXPECT_EQ(result.draftTokensProposed, 6u);
+    EXPECT_EQ(result.draftTokensAccepted, 4u);
+
+    SchedulerStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.decodeSteps, 2u);
+    EXPECT_EQ(stats.rowsDecoded, 8u);
+    EXPECT_EQ(stats.tokensGenerated, 6u);
+    EXPECT_EQ(stats.draftTokensProposed, 6u);
+    EXPECT_EQ(stats.draftTokensAccepted, 4u);
+}
+
+TEST_F(BatchSchedulerTest, SequenceJoinsRunningBatch) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    SequenceRequest second;
+    second.promptTokens = {1, 20};
+    second.maxNewTokens = 2;
+    second.eosToken = -1;
+
+    // The second sequence arrives while the first one decodes its first token
+    std::future<SequenceResult> secondResult;
+    SequenceRequest first;
+    first.promptTokens = {1, 12};
+    first.maxNewTokens = 8;
+    first.eosToken = -1;
+    first.onToken = [&](int) {
+        if (!secondResult.valid()) {
+            secondResult = scheduler.submit(second);
+        }
+        return true;
+    };
+
+    ASSERT_TRUE(scheduler.submit(first).get().success);
+    ASSERT_TRUE(secondResult.valid());
+    ASSERT_TRUE(secondResult.get().success);
+
+    // The second sequence rides along in steps two and three instead of waiting for the first
+    SchedulerStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.decodeSteps, 8u);
+    EXPECT_EQ(stats.rowsDecoded, 10u);
+    EXPECT_GT(stats.rowsDecoded, stats.decodeSteps);
+}
+
+TEST_F(BatchSchedulerTest, FinishedSequenceLeavesWithoutWaitingForTheBatch) {
+    BatchScheduler scheduler(engine_, 4);
+    scheduler.start();
+
+    std::promise<void> shortDone;
+    std::shared_future<void> done = shortDone.get_future().share();
+
+    std::vector<SequenceRequest> requests(2);
+    requests[0].promptTokens = {1, 12};
+    requests[0].maxNewTokens = 2;
+    requests[0].eosToken = -1;
+    requests[0].onComplete = [&shortDone](SequenceResult result) {
+        EXPECT_TRUE(result.success);
+        shortDone.set_value();
+    };
+
+    // The long sequence checks, while it is still decoding, that the short one got its result
+    bool deliveredEarly = false;
+    int generated = 0;
+    requests[1].promptTokens = {1, 20};
+    requests[1].maxNewTokens = 6;
+    requests[1].eosToken = -1;
+    requests[1].onToken = [&](int) {
+        if (++generated == 4) {
+            deliveredEarly = done.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+        }
+        return true;
+    };
+
+    auto futures = scheduler.submitAll(requests);
+    SequenceResult longResult = futures[1].get();
+    ASSERT_TRUE(longResult.success);
+    EXPECT_TRUE(deliveredEarly);
+    EXPECT_EQ(longResult.tokens.size(), 8u);
+
+    // Two shared steps, then the long sequence decodes alone
+    SchedulerStats stats = scheduler.getStats();
+    EXPECT_EQ(stats.decodeSteps, 6u);
+    EXPECT_EQ(stats.rowsDecoded, 8u);
+    EXPECT_EQ(stats.sequencesCompleted, 2u);
+}
+
+} // namespace testing
+} // namespace inference
+} // namespace koebridge
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "inference/engine.h"
+#include "inference/gguf_keys.h"
+#include "one_hot_model.h"
+
+namespace fs = std::filesystem;
+
+namespace koebridge {
+namespace inference {
+namespace testing {
+
+class InferenceEngineTest : public ::testing::Test {
+protected:
+    static constexpr int kVocabSize = 64;
+
+    void SetUp() override {
+        path_ = fs::temp_directory_path() / "inference_engine_test.gguf";
+        ASSERT_TRUE(writeOneHotModel(path_.string(), oneHotVocabulary(kVocabSize)));
+        ASSERT_TRUE(engine_.initialize(path_.string()));
+    }
+
+    void TearDown() override {
+        fs::remove(path_);
+    }
+
+    fs::path path_;
+    InferenceEngine engine_;
+};
+
+TEST_F(InferenceEngineTest, EncoderCacheReusesSameSource) {
+    const std::vector<int> first = {1, 10, 11, 2};
+    const std::vector<int> second = {1, 12, 2};
+
+    auto encoded = engine_.encode(first);
+    ASSERT_TRUE(encoded);
+    ASSERT_TRUE(engine_.encode(second));
+
+    // Encoding the same tokens again hands back the stored states
+    EXPECT_EQ(engine_.encode(first), encoded);
+
+    utils::CacheStats stats = engine_.getEncoderCacheStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.size, 2u);
+}
+
+TEST_F(InferenceEngineTest, InconsistentVocabularyTablesFallBackToMetadata) {
+    const std::vector<std::string> tokens = oneHotVocabulary(kVocabSize);
+
+    // Tables as koebridge-quantize writes them, then damaged by the given edit
+    auto writeWithTables = [&](const std::function<void(int32_t* offsets, int32_t* sorted)>& damage) {
+        return writeOneHotModel(path_.string(), tokens, [&](ggml_context* ctx, gguf_context* gguf) {
+            std::string blobBytes;
+            std::vector<int32_t> offsets;
+            for (const auto& token : tokens) {
+                offsets.push_back(static_cast<int32_t>(blobBytes.size()));
+                blobBytes += token;
+            }
+            offsets.push_back(static_cast<int32_t>(blobBytes.size()));
+            std::vector<int32_t> sorted(tokens.size());
+            std::iota(sorted.begin(), sorted.end(), 0);
+            std::sort(sorted.begin(), sorted.end(), [&](int32_t a, int32_t b) { return tokens[a] < tokens[b]; });
+            damage(offsets.data(), sorted.data());
+
+            ggml_tensor* blob = ggml_new_tensor_1d(ctx, GGML_TYPE_I8, blobBytes.size());
+            ggml_tensor* offsetTable = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, offsets.size());
+            ggml_tensor* sortedTable = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, sorted.size());
+            ggml_set_name(blob, gguf_keys::kVocabBlob);
+            ggml_set_name(offsetTable, gguf_keys::kVocabOffsets);
+            ggml_set_name(sortedTable, gguf_keys::kVocabSorted);
+            std::memcpy(blob->data, blobBytes.data(), blobBytes.size());
+            std::memcpy(offsetTable->data, offsets.data(), offsets.size() * sizeof(int32_t));
+            std::memcpy(sortedTable->data, sorted.data(), sorted.size() * sizeof(int32_t));
+            gguf_add_tensor(gguf, blob);
+            gguf_add_tensor(gguf, offsetTable);
+            gguf_add_tensor(gguf, sortedTable);
+        });
+    };
+
+    const std::vector<std::function<void(int32_t*, int32_t*)>> damages = {
+        [](int32_t*, int32_t*) {},                                  // intact
+        [](int32_t*, int32_t* sorted) { sorted[3] = kVocabSize; },  // ID past the vocabulary
+        [](int32_t* offsets, int32_t*) { offsets[5] = 1 << 20; },   // offset past the blob
+        [](int32_t* offsets, int32_t*) { std::swap(offsets[5], offsets[6]); }, // offsets going back
+        [](int32_t*, int32_t* sorted) { std::swap(sorted[0], sorted[1]); },     // IDs out of byte order
+    };
+    for (size_t i = 0; i < damages.size(); ++i) {
+        InferenceEngine engine;
+        ASSERT_TRUE(writeWithTables(damages[i])) << i;
+        ASSERT_TRUE(engine.initialize(path_.string())) << i;
+        EXPECT_EQ(engine.getVocabSize(), static_cast<size_t>(kVocabSize)) << i;
+        for (int id : {0, 5, 6, 42, kVocabSize - 1}) {
+            EXPECT_EQ(engine.tokenToId("t" + std::to_string(id)), id) << i;
+        }
+    }
+}
+
+} // namespace testing
+} // namespace inference
+} // namespace koebridge
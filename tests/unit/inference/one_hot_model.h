@@ -0,0 +1,73 @@
+/**
+ * @file one_hot_model.h
+ * @brief Tiny GGUF model whose logits echo the input token, shared by the decoder tests
+ */
+
+#pragma once
+
+#include <ggml.h>
+#include <gguf.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include "inference/gguf_keys.h"
+
+namespace koebridge {
+namespace inference {
+namespace testing {
+
+/**
+ * @brief Build the vocabulary "t0", "t1", ... of a one-hot model
+ * @param size Number of tokens
+ * @return std::vector<std::string> Token strings
+ */
+inline std::vector<std::string> oneHotVocabulary(int size) {
+    std::vector<std::string> tokens(size);
+    for (int i = 0; i < size; ++i) {
+        tokens[i] = "t" + std::to_string(i);
+    }
+    return tokens;
+}
+
+/**
+ * @brief Write a model with tied one-hot embeddings: the logits of a row are 1 for its
+ *        input token and 0 elsewhere, so greedy decoding repeats the last token
+ * @param path File to write
+ * @param tokens Vocabulary, one embedding row per token
+ * @param addTensors Optional hook adding further tensors, created in the given context
+ * @return bool True if the file was written
+ */
+inline bool writeOneHotModel(const std::string& path, const std::vector<std::string>& tokens,
+                             const std::function<void(ggml_context*, gguf_context*)>& addTensors = nullptr) {
+    const int vocabSize = static_cast<int>(tokens.size());
+    ggml_init_params params = {static_cast<size_t>(vocabSize) * vocabSize * sizeof(float) + (1 << 16), nullptr, false};
+    ggml_context* ctx = ggml_init(params);
+    ggml_tensor* embedding = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, vocabSize, vocabSize);
+    ggml_set_name(embedding, gguf_keys::kTokenEmbedding);
+    float* data = static_cast<float*>(embedding->data);
+    std::fill(data, data + vocabSize * vocabSize, 0.0f);
+    for (int i = 0; i < vocabSize; ++i) {
+        data[i * vocabSize + i] = 1.0f;
+    }
+
+    std::vector<const char*> tokenPointers(vocabSize);
+    for (int i = 0; i < vocabSize; ++i) {
+        tokenPointers[i] = tokens[i].c_str();
+    }
+
+    gguf_context* gguf = gguf_init_empty();
+    gguf_set_arr_str(gguf, gguf_keys::kTokens, tokenPointers.data(), vocabSize);
+    gguf_add_tensor(gguf, embedding);
+    if (addTensors) {
+        addTensors(ctx, gguf);
+    }
+    const bool written = gguf_write_to_file(gguf, path.c_str(), false);
+    gguf_free(gguf);
+    ggml_free(ctx);
+    return written;
+}
+
+} // namespace testing
+} // namespace inference
+} // namespace koebridge
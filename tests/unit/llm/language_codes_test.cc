@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include "llm/language_codes.h"
+
+namespace koebridge {
+namespace llm {
+namespace testing {
+
+TEST(LanguageCodesTest, FindsEveryCode) {
+    for (size_t i = 0; i < kLanguageCount; ++i) {
+        EXPECT_EQ(languageIndex(kLanguageCodes[i]), static_cast<int>(i)) << kLanguageCodes[i];
+    }
+}
+
+TEST(LanguageCodesTest, CodesAreUnique) {
+    std::set<std::string_view> codes(kLanguageCodes.begin(), kLanguageCodes.end());
+    EXPECT_EQ(codes.size(), kLanguageCount);
+}
+
+TEST(LanguageCodesTest, AcceptsTokenFormAndAliases) {
+    const int japanese = languageIndex("jpn_Jpan");
+    ASSERT_GE(japanese, 0);
+    EXPECT_EQ(languageIndex("__jpn_Jpan__"), japanese);
+    EXPECT_EQ(languageIndex("ja"), japanese);
+    EXPECT_EQ(languageIndex(std::string("eng_Latn")), languageIndex("en"));
+}
+
+TEST(LanguageCodesTest, RejectsUnknownCodes) {
+    EXPECT_EQ(languageIndex(""), -1);
+    EXPECT_EQ(languageIndex("jpn"), -1);
+    EXPECT_EQ(languageIndex("xxx_Xxxx"), -1);
+    EXPECT_EQ(languageIndex("jpn_Jpann"), -1);
+    EXPECT_EQ(languageIndex("____"), -1);
+}
+
+} // namespace testing
+} // namespace llm
+} // namespace koebridge
@@ -130,6 +130,26 @@ TEST_F(LLMManagerTest, GetModel) {
     EXPECT_NE(llmManager_->getModel(), nullptr);
 }
 
+TEST_F(LLMManagerTest, ModelsStayResident) {
+    ASSERT_TRUE(llmManager_->loadModel("valid_model"));
+    std::shared_ptr<LLMModel> model = llmManager_->getModel();
+
+    // Loading a resident model again reuses it
+    ASSERT_TRUE(llmManager_->loadModel("valid_model"));
+    EXPECT_EQ(llmManager_->getModel(), model);
+    EXPECT_EQ(llmManager_->acquireModel("valid_model"), model);
+    EXPECT_EQ(llmManager_->acquireModel("invalid_model"), nullptr);
+    ASSERT_EQ(llmManager_->getResidentModels().size(), 1u);
+
+    // The active model survives any budget
+    llmManager_->setMemoryBudget(1);
+    EXPECT_EQ(llmManager_->getModel(), model);
+    EXPECT_EQ(llmManager_->getResidentModels().size(), 1u);
+
+    EXPECT_TRUE(llmManager_->unloadModel());
+    EXPECT_TRUE(llmManager_->getResidentModels().empty());
+}
+
 TEST_F(LLMManagerTest, TextCompletion) {
     // No model loaded yet
     LLMOutput output = llmManager_->complete("Hello, world!");
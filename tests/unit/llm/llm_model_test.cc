@@ -96,6 +96,25 @@ TEST_F(LLMModelTest, AsyncCompletion) {
     EXPECT_FALSE(output.text.empty());
 }
 
+TEST_F(LLMModelTest, StreamingCompletion) {
+    // Initialize the model
+    ASSERT_TRUE(model_->initialize());
+
+    // Collect the pieces as they are generated
+    std::string streamed;
+    size_t pieces = 0;
+    LLMOutput output = model_->completeStream("Hello, world!", [&](const std::string& piece) {
+        streamed += piece;
+        ++pieces;
+        return true;
+    });
+
+    // The pieces add up to the final text
+    EXPECT_TRUE(output.success);
+    EXPECT_EQ(streamed, output.text);
+    EXPECT_GT(pieces, 0u);
+}
+
 TEST_F(LLMModelTest, ConfigurationChanges) {
     // Initialize with default config
     ASSERT_TRUE(model_->initialize());
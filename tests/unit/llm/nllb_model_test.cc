@@ -4,8 +4,10 @@
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <future>
 #include "llm/nllb_model.h"
 #include "translation/data_structures.h"
+#include "../inference/one_hot_model.h"
 
 namespace fs = std::filesystem;
 
@@ -30,7 +32,7 @@ protected:
         config_.beamSize = 4;
 
         // Create model instance
-        model_ = std::make_unique<NLLBModel>(modelInfo_, "eng", "jpn", config_);
+        model_ = std::make_unique<NLLBModel>(modelInfo_, "eng_Latn", "jpn_Jpan", config_);
     }
 
     void TearDown() override {
@@ -47,11 +49,11 @@ TEST_F(NLLBModelTest, Initialize) {
 }
 
 TEST_F(NLLBModelTest, SetLanguages) {
-    model_->setSourceLanguage("fra");
-    model_->setTargetLanguage("deu");
+    model_->setSourceLanguage("fra_Latn");
+    model_->setTargetLanguage("deu_Latn");
 
-    EXPECT_EQ(model_->getSourceLanguage(), "fra");
-    EXPECT_EQ(model_->getTargetLanguage(), "deu");
+    EXPECT_EQ(model_->getSourceLanguage(), "fra_Latn");
+    EXPECT_EQ(model_->getTargetLanguage(), "deu_Latn");
 }
 
 TEST_F(NLLBModelTest, Translate) {
@@ -64,6 +66,54 @@ TEST_F(NLLBModelTest, Translate) {
     EXPECT_FALSE(output.text.empty());
 }
 
+TEST_F(NLLBModelTest, TranslateMulti) {
+    ASSERT_TRUE(model_->initialize());
+
+    auto outputs = model_->translateMulti("こんにちは", "jpn_Jpan", {"en", "zh", "ko", "invalid_lang"});
+
+    ASSERT_EQ(outputs.size(), 4u);
+    for (const char* language : {"en", "zh", "ko"}) {
+        EXPECT_TRUE(outputs[language].success) << language;
+        EXPECT_GT(outputs[language].stats.inputTokenCount, 0) << language;
+    }
+    EXPECT_FALSE(outputs["invalid_lang"].success);
+
+    // Fan-out leaves the model's own language pair alone
+    EXPECT_EQ(model_->getTargetLanguage(), "jpn_Jpan");
+}
+
+TEST_F(NLLBModelTest, TranslateMultiCancelled) {
+    ASSERT_TRUE(model_->initialize());
+
+    auto cancellation = std::make_shared<utils::CancellationToken>();
+    cancellation->cancel();
+    auto outputs = model_->translateMulti("こんにちは", "jpn_Jpan", {"en", "ko"}, cancellation);
+
+    ASSERT_EQ(outputs.size(), 2u);
+    for (const char* language : {"en", "ko"}) {
+        EXPECT_FALSE(outputs[language].success) << language;
+        EXPECT_TRUE(outputs[language].partial) << language;
+        EXPECT_EQ(outputs[language].errorMessage, "Cancelled") << language;
+    }
+}
+
+TEST_F(NLLBModelTest, PerRequestLanguagePair) {
+    ASSERT_TRUE(model_->initialize());
+
+    // Requests for different pairs share the model and leave its defaults alone
+    auto toKorean = std::async(std::launch::async, [this] {
+        return model_->translate("こんにちは", LanguagePair{"jpn_Jpan", "kor_Hang"});
+    });
+    auto toFrench = std::async(std::launch::async, [this] {
+        return model_->translate("Hello", LanguagePair{"eng_Latn", "fra_Latn"});
+    });
+
+    EXPECT_TRUE(toKorean.get().success);
+    EXPECT_TRUE(toFrench.get().success);
+    EXPECT_EQ(model_->getSourceLanguage(), "eng_Latn");
+    EXPECT_EQ(model_->getTargetLanguage(), "jpn_Jpan");
+}
+
 TEST_F(NLLBModelTest, PromptFormatting) {
     // Initialize the model
     ASSERT_TRUE(model_->initialize());
@@ -72,10 +122,8 @@ TEST_F(NLLBModelTest, PromptFormatting) {
     std::string prompt = "こんにちは";
     std::string formattedPrompt = model_->formatPrompt(prompt);
 
-    // The formatted prompt should contain language tokens
-    EXPECT_TRUE(formattedPrompt.find("250025") != std::string::npos); // Japanese token
-    EXPECT_TRUE(formattedPrompt.find("250004") != std::string::npos); // English token
-    EXPECT_TRUE(formattedPrompt.find(prompt) != std::string::npos);   // Original text
+    // Language tokens are added during tokenization, not to the text
+    EXPECT_EQ(formattedPrompt, prompt);
 }
 
 TEST_F(NLLBModelTest, UnsupportedLanguagePair) {
@@ -94,6 +142,120 @@ TEST_F(NLLBModelTest, UnsupportedLanguagePair) {
     EXPECT_FALSE(output.text.empty());
 }
 
+class NLLBOneHotModelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // The one-hot model echoes its input, so each target decodes its own language token
+        std::vector<std::string> vocabulary = inference::testing::oneHotVocabulary(64);
+        vocabulary[60] = "__eng_Latn__";
+        vocabulary[61] = "__fra_Latn__";
+        vocabulary[62] = "__deu_Latn__";
+        path_ = fs::temp_directory_path() / "nllb_one_hot_test.gguf";
+        ASSERT_TRUE(inference::testing::writeOneHotModel(path_.string(), vocabulary));
+
+        modelInfo_.id = "one_hot_nllb";
+        modelInfo_.path = path_.string();
+        modelInfo_.modelType = "nllb";
+
+        // Greedy, unrestricted decoding
+        config_.maxLength = 2;
+        config_.topK = 1;
+        config_.repeatPenalty = 1.0f;
+        config_.useShortlist = false;
+
+        model_ = std::make_unique<NLLBModel>(modelInfo_, "eng_Latn", "fra_Latn", config_);
+        ASSERT_TRUE(model_->initialize());
+    }
+
+    void TearDown() override {
+        model_.reset();
+        fs::remove(path_);
+    }
+
+    utils::CacheStats encoderCacheStats() const {
+        return model_->engine_->getEncoderCacheStats();
+    }
+
+    fs::path path_;
+    translation::ModelInfo modelInfo_;
+    LLMConfig config_;
+    std::unique_ptr<NLLBModel> model_;
+};
+
+TEST_F(NLLBOneHotModelTest, TargetLanguageTokenStartsTheDecoder) {
+    auto outputs = model_->translateMulti("t10 t11", "eng_Latn", {"fra_Latn", "deu_Latn"});
+
+    ASSERT_TRUE(outputs["fra_Latn"].success);
+    ASSERT_TRUE(outputs["deu_Latn"].success);
+    EXPECT_NE(outputs["fra_Latn"].text, outputs["deu_Latn"].text);
+    EXPECT_NE(outputs["fra_Latn"].text.find("__fra_Latn__"), std::string::npos);
+    EXPECT_NE(outputs["deu_Latn"].text.find("__deu_Latn__"), std::string::npos);
+
+    // The single-target path uses the same decoder prefix
+    LLMOutput output = model_->translate("t10 t11", LanguagePair{"eng_Latn", "deu_Latn"});
+    ASSERT_TRUE(output.success);
+    EXPECT_EQ(output.text, outputs["deu_Latn"].text);
+}
+
+TEST_F(NLLBOneHotModelTest, EveryTargetSharesTheEncodedSource) {
+    ASSERT_TRUE(model_->translate("t10 t11", LanguagePair{"eng_Latn", "fra_Latn"}).success);
+    utils::CacheStats stats = encoderCacheStats();
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 1u);
+
+    // The encoder input has no target language token, so another target reuses it
+    ASSERT_TRUE(model_->translate("t10 t11", LanguagePair{"eng_Latn", "deu_Latn"}).success);
+    auto outputs = model_->translateMulti("t10 t11", "eng_Latn", {"fra_Latn", "deu_Latn"});
+    ASSERT_TRUE(outputs["fra_Latn"].success);
+    stats = encoderCacheStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.size, 1u);
+}
+
+TEST_F(NLLBOneHotModelTest, TranslateAsyncMatchesTranslate) {
+    translation::TranslationOptions options;
+    options.targetLanguage = "deu_Latn";
+
+    translation::TranslationResult expected = model_->translate("t10 t11", options);
+    translation::TranslationResult result = model_->translateAsync("t10 t11", options).get();
+    ASSERT_TRUE(result.success);
+    EXPECT_EQ(result.text, expected.text);
+}
+
+TEST_F(NLLBOneHotModelTest, DraftStatsReachInferenceStats) {
+    LLMOutput plain = model_->translate("t10 t11", LanguagePair{"eng_Latn", "deu_Latn"});
+
+    // A draft identical to the model proposes exactly what the model samples
+    auto draft = std::make_shared<NLLBModel>(modelInfo_, "eng_Latn", "fra_Latn", config_);
+    ASSERT_TRUE(draft->initialize());
+    ASSERT_TRUE(model_->setDraftModel(draft));
+
+    LLMOutput output = model_->translate("t10 t11", LanguagePair{"eng_Latn", "deu_Latn"});
+    ASSERT_TRUE(output.success);
+    EXPECT_EQ(output.text, plain.text);
+    EXPECT_GT(output.stats.draftTokenCount, 0);
+    EXPECT_EQ(output.stats.acceptedDraftTokenCount, output.stats.draftTokenCount);
+    EXPECT_DOUBLE_EQ(output.stats.draftAcceptanceRate, 1.0);
+
+    ASSERT_TRUE(model_->setDraftModel(nullptr));
+}
+
+TEST(NLLBModelVocabularyTest, RequiresLanguageTokens) {
+    const fs::path path = fs::temp_directory_path() / "nllb_no_languages_test.gguf";
+    ASSERT_TRUE(inference::testing::writeOneHotModel(path.string(), inference::testing::oneHotVocabulary(64)));
+
+    translation::ModelInfo modelInfo;
+    modelInfo.id = "no_languages";
+    modelInfo.path = path.string();
+    modelInfo.modelType = "nllb";
+    {
+        NLLBModel model(modelInfo, "eng_Latn", "fra_Latn");
+        EXPECT_FALSE(model.initialize());
+    }
+    fs::remove(path);
+}
+
 } // namespace testing
 } // namespace llm
 } // namespace koebridge
\ No newline at end of file
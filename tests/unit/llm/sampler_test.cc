@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "llm/sampler.h"
+
+namespace koebridge {
+namespace llm {
+namespace testing {
+
+class SamplerTest : public ::testing::Test {
+protected:
+    static SamplingParams disabledParams() {
+        SamplingParams params;
+        params.temperature = 0.0f;
+        params.topK = 0;
+        params.topP = 1.0f;
+        params.repeatPenalty = 1.0f;
+        return params;
+    }
+
+    static inference::LogitsSpan span(std::vector<float>& logits) {
+        return inference::LogitsSpan(logits.data(), logits.size());
+    }
+};
+
+TEST_F(SamplerTest, EmptyLogitsReturnNoToken) {
+    Sampler sampler(disabledParams());
+    std::vector<float> logits;
+    EXPECT_EQ(sampler.sample(span(logits), {}), -1);
+}
+
+TEST_F(SamplerTest, TopKKeepsBestCandidatesInOrder) {
+    SamplingParams params = disabledParams();
+    params.topK = 2;
+    Sampler sampler(params);
+
+    std::vector<float> logits = {0.1f, 3.0f, -1.0f, 2.0f, 0.5f};
+    ASSERT_EQ(sampler.selectCandidates(span(logits)), 2u);
+    EXPECT_EQ(sampler.getCandidates(), (std::vector<int>{1, 3}));
+}
+
+TEST_F(SamplerTest, ProbabilitiesMatchSoftmax) {
+    SamplingParams params = disabledParams();
+    params.temperature = 0.5f;
+    Sampler sampler(params);
+
+    std::vector<float> logits = {1.0f, -2.0f, 0.25f, -30.0f, 4.0f, 0.0f, -INFINITY, 2.5f, 1.5f};
+    sampler.selectCandidates(span(logits));
+    const float sum = sampler.computeProbabilities();
+
+    double expected = 0.0;
+    for (float logit : logits) {
+        expected += std::exp((logit - 4.0) / 0.5);
+    }
+    EXPECT_NEAR(sum, expected, expected * 1e-5);
+}
+
+TEST_F(SamplerTest, TopPKeepsSmallestPrefixReachingMass) {
+    SamplingParams params = disabledParams();
+    params.topP = 0.8f;
+    Sampler sampler(params);
+
+    // Probabilities 0.5, 0.25, 0.125, 0.125
+    std::vector<float> logits = {std::log(0.125f), std::log(0.5f), std::log(0.125f), std::log(0.25f)};
+    sampler.selectCandidates(span(logits));
+    const float sum = sampler.computeProbabilities();
+    const float kept = sampler.applyTopP(sum);
+
+    ASSERT_EQ(sampler.getCandidates().size(), 3u);
+    EXPECT_EQ(sampler.getCandidates()[0], 1);
+    EXPECT_EQ(sampler.getCandidates()[1], 3);
+    EXPECT_NEAR(kept / sum, 0.875f, 1e-5);
+}
+
+TEST_F(SamplerTest, RepeatPenaltyLowersSeenTokens) {
+    SamplingParams params = disabledParams();
+    params.repeatPenalty = 2.0f;
+    Sampler sampler(params);
+
+    std::vector<float> logits = {4.0f, 4.0f, 4.0f};
+    sampler.applyRepeatPenalty(span(logits), {1});
+    EXPECT_FLOAT_EQ(logits[0], 4.0f);
+    EXPECT_FLOAT_EQ(logits[1], 2.0f);
+    EXPECT_FLOAT_EQ(logits[2], 4.0f);
+}
+
+TEST_F(SamplerTest, SingleSurvivorIsAlwaysDrawn) {
+    SamplingParams params = disabledParams();
+    params.topK = 1;
+    Sampler sampler(params);
+
+    for (int i = 0; i < 20; ++i) {
+        std::vector<float> logits = {0.5f, 0.2f, 5.0f, 0.1f};
+        EXPECT_EQ(sampler.sample(span(logits), {}), 2);
+    }
+}
+
+TEST_F(SamplerTest, RepeatPenaltyAppliesOncePerDistinctToken) {
+    SamplingParams params = disabledParams();
+    params.repeatPenalty = 2.0f;
+    Sampler sampler(params);
+
+    std::vector<float> logits = {4.0f, -4.0f, 4.0f};
+    sampler.applyRepeatPenalty(span(logits), {0, 0, 0, 1, 1});
+    EXPECT_FLOAT_EQ(logits[0], 2.0f);
+    EXPECT_FLOAT_EQ(logits[1], -8.0f);
+    EXPECT_FLOAT_EQ(logits[2], 4.0f);
+}
+
+TEST_F(SamplerTest, RepeatPenaltyOnlySeesRecentWindow) {
+    SamplingParams params = disabledParams();
+    params.repeatPenalty = 2.0f;
+    params.repeatWindow = 2;
+    Sampler sampler(params);
+
+    std::vector<int> history = {0, 1, 2};
+    std::vector<float> logits = {4.0f, 4.0f, 4.0f, 4.0f};
+    sampler.applyRepeatPenalty(span(logits), history);
+    EXPECT_EQ(logits, (std::vector<float>{4.0f, 2.0f, 2.0f, 4.0f}));
+
+    // Growing the history slides the window incrementally
+    history.push_back(3);
+    logits = {4.0f, 4.0f, 4.0f, 4.0f};
+    sampler.applyRepeatPenalty(span(logits), history);
+    EXPECT_EQ(logits, (std::vector<float>{4.0f, 4.0f, 2.0f, 2.0f}));
+}
+
+TEST_F(SamplerTest, SameSeedReproducesTokens) {
+    SamplingParams params = disabledParams();
+    params.seed = 1234;
+    Sampler first(params);
+    Sampler second(params);
+
+    std::vector<int> firstTokens;
+    std::vector<int> secondTokens;
+    for (int i = 0; i < 50; ++i) {
+        std::vector<float> logits = {0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f};
+        firstTokens.push_back(first.sample(span(logits), {}));
+        logits = {0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f};
+        secondTokens.push_back(second.sample(span(logits), {}));
+    }
+    EXPECT_EQ(firstTokens, secondTokens);
+
+    // A flat distribution over eight tokens should not collapse onto one of them
+    std::sort(firstTokens.begin(), firstTokens.end());
+    EXPECT_GT(std::unique(firstTokens.begin(), firstTokens.end()) - firstTokens.begin(), 1);
+}
+
+} // namespace testing
+} // namespace llm
+} // namespace koebridge
@@ -8,6 +8,8 @@
 #include <fstream>
 #include <thread>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include "../../../src/translation/model_manager.h"
 #include "../../../src/utils/config.h"
 
@@ -181,6 +183,63 @@ TEST_F(ModelManagerTest, UnloadModel) {
         << "Model should be unloaded";
 }
 
+TEST_F(ModelManagerTest, LoadModelAsyncSwapsModels) {
+    auto models = manager_->getAvailableModels();
+    if (models.size() < 2) {
+        GTEST_SKIP() << "Need two models for testing";
+    }
+
+    ASSERT_TRUE(manager_->loadModel(models[0].id));
+    auto previous = manager_->getTranslationModel();
+
+    std::vector<int> progress;
+    auto future = manager_->loadModelAsync(models[1].id, [&](int value, const std::string&) {
+        progress.push_back(value);
+    });
+    ASSERT_TRUE(future.get()) << "Failed to load model: " << models[1].id;
+
+    EXPECT_EQ(manager_->getActiveModel().id, models[1].id);
+    EXPECT_NE(manager_->getTranslationModel(), previous);
+    ASSERT_FALSE(progress.empty());
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    EXPECT_EQ(progress.back(), 100);
+
+    // The old model stays usable by whoever still holds it
+    TranslationResult result = previous->translate("test", TranslationOptions());
+    EXPECT_TRUE(result.success);
+}
+
+TEST_F(ModelManagerTest, TranslateWhileSwapping) {
+    auto models = manager_->getAvailableModels();
+    if (models.size() < 2) {
+        GTEST_SKIP() << "Need two models for testing";
+    }
+
+    ASSERT_TRUE(manager_->loadModel(models[0].id));
+
+    // Readers never block on the swap and always see one complete model
+    std::vector<std::thread> readers;
+    std::atomic<int> failures{0};
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            for (int j = 0; j < 100; ++j) {
+                if (!manager_->translate("test", TranslationOptions()).success || !manager_->isModelLoaded()) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(manager_->loadModel(models[i % 2 ? 0 : 1].id));
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(manager_->getActiveModel().id, models[0].id);
+}
+
 TEST_F(ModelManagerTest, GetTranslationModel) {
     auto models = manager_->getAvailableModels();
     if (models.empty()) {
@@ -0,0 +1,145 @@
+/**
+ * @file priority_executor_test.cc
+ * @brief Unit tests for the PriorityExecutor class
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "translation/priority_executor.h"
+
+using namespace koebridge::translation;
+
+namespace {
+
+// Occupies a worker until released
+struct Gate {
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    std::function<void()> task() {
+        return [this] {
+            entered.set_value();
+            released.wait();
+        };
+    }
+};
+
+} // namespace
+
+TEST(PriorityExecutorTest, RunsSubmittedTasks) {
+    PriorityExecutor executor(2, 0, 0);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 8; ++i) {
+        auto promise = std::make_shared<std::promise<int>>();
+        results.push_back(promise->get_future());
+        ASSERT_TRUE(executor.submit(i % 2 ? TaskPriority::BULK : TaskPriority::LIVE, [promise, i] {
+            promise->set_value(i);
+        }));
+    }
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(results[i].get(), i);
+    }
+
+    executor.stop();
+    EXPECT_EQ(executor.getStats(TaskPriority::LIVE).completed, 4u);
+    EXPECT_EQ(executor.getStats(TaskPriority::BULK).completed, 4u);
+}
+
+TEST(PriorityExecutorTest, LiveRunsBeforeQueuedBulk) {
+    PriorityExecutor executor(1, 0, 0);
+    Gate gate;
+    ASSERT_TRUE(executor.submit(TaskPriority::BULK, gate.task()));
+    gate.entered.get_future().wait();
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    std::promise<void> done;
+    ASSERT_TRUE(executor.submit(TaskPriority::BULK, [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back("bulk");
+        done.set_value();
+    }));
+    ASSERT_TRUE(executor.submit(TaskPriority::LIVE, [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back("live");
+    }));
+
+    gate.release.set_value();
+    done.get_future().wait();
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], "live");
+}
+
+TEST(PriorityExecutorTest, BulkLeavesWorkerForLive) {
+    PriorityExecutor executor(2, 0, 0);
+    Gate gate;
+    ASSERT_TRUE(executor.submit(TaskPriority::BULK, gate.task()));
+    gate.entered.get_future().wait();
+
+    // A second bulk task may not take the last worker
+    std::promise<void> bulkRan;
+    ASSERT_TRUE(executor.submit(TaskPriority::BULK, [&] { bulkRan.set_value(); }));
+    std::promise<void> liveRan;
+    ASSERT_TRUE(executor.submit(TaskPriority::LIVE, [&] { liveRan.set_value(); }));
+
+    EXPECT_EQ(liveRan.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto bulkDone = bulkRan.get_future();
+    EXPECT_EQ(bulkDone.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+    gate.release.set_value();
+    EXPECT_EQ(bulkDone.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+TEST(PriorityExecutorTest, StopAbandonsQueuedTasks) {
+    PriorityExecutor executor(1, 0, 0);
+    Gate gate;
+    ASSERT_TRUE(executor.submit(TaskPriority::LIVE, gate.task()));
+    gate.entered.get_future().wait();
+
+    std::vector<std::future<std::string>> results;
+    for (int i = 0; i < 3; ++i) {
+        auto promise = std::make_shared<std::promise<std::string>>();
+        results.push_back(promise->get_future());
+        ASSERT_TRUE(executor.submit(i % 2 ? TaskPriority::BULK : TaskPriority::LIVE,
+            [promise] { promise->set_value("ran"); },
+            [promise] { promise->set_value("abandoned"); }));
+    }
+
+    // stop() takes the queued tasks first, then waits for the running one
+    auto stopped = std::async(std::launch::async, [&executor] { executor.stop(); });
+    while (executor.getStats(TaskPriority::LIVE).queued + executor.getStats(TaskPriority::BULK).queued > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    gate.release.set_value();
+    stopped.get();
+
+    for (auto& result : results) {
+        EXPECT_EQ(result.get(), "abandoned");
+    }
+    EXPECT_EQ(executor.getStats(TaskPriority::LIVE).completed, 1u);
+}
+
+TEST(PriorityExecutorTest, RejectsWhenLaneIsFull) {
+    PriorityExecutor executor(1, 0, 1);
+    Gate gate;
+    ASSERT_TRUE(executor.submit(TaskPriority::LIVE, gate.task()));
+    gate.entered.get_future().wait();
+
+    EXPECT_TRUE(executor.submit(TaskPriority::BULK, [] {}));
+    EXPECT_FALSE(executor.submit(TaskPriority::BULK, [] {}));
+    EXPECT_TRUE(executor.submit(TaskPriority::LIVE, [] {}));
+
+    LaneStats bulk = executor.getStats(TaskPriority::BULK);
+    EXPECT_EQ(bulk.queued, 1u);
+    EXPECT_EQ(bulk.rejected, 1u);
+
+    gate.release.set_value();
+    executor.stop();
+    EXPECT_FALSE(executor.submit(TaskPriority::LIVE, [] {}));
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "translation/translation_memory.h"
+
+namespace fs = std::filesystem;
+
+namespace koebridge {
+namespace translation {
+namespace testing {
+
+class TranslationMemoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = fs::temp_directory_path() /
+            ("translation_memory_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(directory_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(directory_);
+    }
+
+    fs::path directory_;
+};
+
+TEST_F(TranslationMemoryTest, EntriesSurviveReopening) {
+    {
+        TranslationMemory memory;
+        ASSERT_TRUE(memory.open(directory_.string(), 1 << 20));
+        memory.store("こんにちは\x1fnllb", "Hello");
+        memory.store("ありがとう\x1fnllb", "Thank you");
+        memory.flush();
+
+        std::string text;
+        EXPECT_TRUE(memory.lookup("こんにちは\x1fnllb", text));
+        EXPECT_EQ(text, "Hello");
+        EXPECT_FALSE(memory.lookup("さようなら\x1fnllb", text));
+    }
+
+    TranslationMemory memory;
+    ASSERT_TRUE(memory.open(directory_.string(), 1 << 20));
+    std::string text;
+    EXPECT_TRUE(memory.lookup("ありがとう\x1fnllb", text));
+    EXPECT_EQ(text, "Thank you");
+    EXPECT_EQ(memory.getStats().entries, 2u);
+}
+
+TEST_F(TranslationMemoryTest, NewerEntryReplacesOlder) {
+    TranslationMemory memory;
+    ASSERT_TRUE(memory.open(directory_.string(), 1 << 20));
+    memory.store("key", "first");
+    memory.store("key", "second");
+    memory.flush();
+
+    std::string text;
+    EXPECT_TRUE(memory.lookup("key", text));
+    EXPECT_EQ(text, "second");
+    EXPECT_EQ(memory.getStats().entries, 1u);
+}
+
+TEST_F(TranslationMemoryTest, TornRecordIsCutOff) {
+    {
+        TranslationMemory memory;
+        ASSERT_TRUE(memory.open(directory_.string(), 1 << 20));
+        memory.store("key", "value");
+    }
+    const auto goodSize = fs::file_size(directory_ / "memory.log");
+    {
+        std::ofstream log(directory_ / "memory.log", std::ios::binary | std::ios::app);
+        log << "\x05\x00\x00";
+    }
+    // The index no longer covers the end of the log, as after a crash
+    fs::remove(directory_ / "memory.idx");
+
+    TranslationMemory memory;
+    ASSERT_TRUE(memory.open(directory_.string(), 1 << 20));
+    EXPECT_EQ(fs::file_size(directory_ / "memory.log"), goodSize);
+
+    std::string text;
+    EXPECT_TRUE(memory.lookup("key", text));
+    EXPECT_EQ(text, "value");
+
+    memory.store("other", "entry");
+    memory.flush();
+    EXPECT_TRUE(memory.lookup("other", text));
+}
+
+TEST_F(TranslationMemoryTest, IndexGrows) {
+    TranslationMemory memory;
+    ASSERT_TRUE(memory.open(directory_.string(), 16 << 20));
+    for (int i = 0; i < 10000; ++i) {
+        memory.store("key" + std::to_string(i), "value" + std::to_string(i));
+        // Stay below the write queue limit
+        if (i % 1000 == 999) {
+            memory.flush();
+        }
+    }
+
+    EXPECT_EQ(memory.getStats().entries, 10000u);
+    for (int i = 0; i < 10000; i += 997) {
+        std::string text;
+        ASSERT_TRUE(memory.lookup("key" + std::to_string(i), text)) << i;
+        EXPECT_EQ(text, "value" + std::to_string(i));
+    }
+}
+
+TEST_F(TranslationMemoryTest, SizeLimitDropsNewEntries) {
+    TranslationMemory memory;
+    ASSERT_TRUE(memory.open(directory_.string(), 64));
+    memory.store("short", "entry");
+    memory.store(std::string(100, 'k'), "too large");
+    memory.flush();
+
+    auto stats = memory.getStats();
+    EXPECT_EQ(stats.writes, 1u);
+    EXPECT_EQ(stats.dropped, 1u);
+    EXPECT_LE(stats.logBytes, 64u);
+}
+
+TEST_F(TranslationMemoryTest, RejectsForeignLog) {
+    fs::create_directories(directory_);
+    {
+        std::ofstream log(directory_ / "memory.log", std::ios::binary);
+        log << "not a translation memory";
+    }
+
+    TranslationMemory memory;
+    EXPECT_FALSE(memory.open(directory_.string(), 1 << 20));
+    EXPECT_FALSE(memory.isOpen());
+}
+
+} // namespace testing
+} // namespace translation
+} // namespace koebridge
@@ -2,10 +2,13 @@
 #include <QCoreApplication>
 #include <QEventLoop>
 #include <QTimer>
+#include <filesystem>
 #include "../../../src/translation/translation_service.h"
 #include "../../../src/translation/model_manager.h"
+#include "../../../src/utils/config.h"
 
 using namespace koebridge::translation;
+namespace fs = std::filesystem;
 
 class TranslationServiceTest : public ::testing::Test {
 protected:
@@ -17,6 +20,14 @@ protected:
             app = std::make_unique<QCoreApplication>(argc, argv);
         }
 
+        // Every test starts from an empty translation memory of its own
+        const std::string testName = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        memoryPath = fs::temp_directory_path() / ("translation_service_test_" + testName);
+        fs::remove_all(memoryPath);
+        koebridge::utils::Config& config = koebridge::utils::Config::getInstance();
+        previousMemoryPath = config.getString("translation.memory_path");
+        config.setString("translation.memory_path", memoryPath.string());
+
         // Create model manager and translation service
         modelManager = std::make_shared<ModelManager>("./test_models");
         translator = std::make_unique<TranslationService>(modelManager);
@@ -25,6 +36,8 @@ protected:
     void TearDown() override {
         translator.reset();
         modelManager.reset();
+        koebridge::utils::Config::getInstance().setString("translation.memory_path", previousMemoryPath);
+        fs::remove_all(memoryPath);
     }
 
     // Helper function to wait for async operations
@@ -35,6 +48,8 @@ protected:
     }
 
     std::unique_ptr<QCoreApplication> app;
+    fs::path memoryPath;
+    std::string previousMemoryPath;
     std::shared_ptr<ModelManager> modelManager;
     std::unique_ptr<TranslationService> translator;
 };
@@ -104,4 +119,75 @@ TEST_F(TranslationServiceTest, TestErrorHandling) {
     modelManager->loadModel("non_existent_model");
     result = translator->translateText("こんにちは");
     EXPECT_FALSE(result.empty());  // Updated to match the current implementation
-}
\ No newline at end of file
+}
+TEST_F(TranslationServiceTest, TestRepeatedTextIsCached) {
+    translator->initialize();
+    std::string first = translator->translateText("こんにちは");
+    std::string second = translator->translateText("  こんにちは ");
+
+    // Whitespace differences share the entry, the second call skips the model
+    EXPECT_EQ(first, second);
+    auto stats = translator->getCacheStats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.size, 1u);
+
+    translator->clearCache();
+    EXPECT_EQ(translator->getCacheStats().size, 0u);
+}
+
+TEST_F(TranslationServiceTest, TestIdenticalAsyncRequestsAreCoalesced) {
+    translator->initialize();
+    translator->clearCache();
+    int callbacks = 0;
+    std::string first;
+    std::string second;
+
+    translator->translateTextAsync("よろしくお願いします", [&](const TranslationResult& result) {
+        ++callbacks;
+        first = result.text;
+    });
+    translator->translateTextAsync("よろしくお願いします", [&](const TranslationResult& result) {
+        ++callbacks;
+        second = result.text;
+    });
+
+    waitForAsync();
+    EXPECT_EQ(callbacks, 2);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(translator->getCoalescedRequests(), 1u);
+}
+
+TEST_F(TranslationServiceTest, TestCancellingOneCoalescedCallerKeepsTheOthers) {
+    translator->initialize();
+    translator->clearCache();
+    int firstCallbacks = 0;
+    int secondCallbacks = 0;
+    TranslationResult first;
+    std::string second;
+
+    auto firstToken = translator->translateTextAsync("お疲れ様です", [&](const TranslationResult& result) {
+        ++firstCallbacks;
+        first = result;
+    });
+    auto secondToken = translator->translateTextAsync("お疲れ様です", [&](const TranslationResult& result) {
+        ++secondCallbacks;
+        second = result.text;
+    });
+    ASSERT_TRUE(firstToken);
+    ASSERT_TRUE(secondToken);
+    EXPECT_NE(firstToken, secondToken);
+
+    // Only the caller that cancelled is dropped, right away, the translation runs on for the other
+    firstToken->cancel();
+    EXPECT_FALSE(secondToken->shouldStop());
+    EXPECT_EQ(firstCallbacks, 1);
+    EXPECT_TRUE(first.partial);
+    EXPECT_EQ(first.errorMessage, "Cancelled");
+
+    waitForAsync();
+    EXPECT_EQ(firstCallbacks, 1);
+    EXPECT_EQ(secondCallbacks, 1);
+    EXPECT_FALSE(second.empty());
+    EXPECT_EQ(translator->getCoalescedRequests(), 1u);
+}
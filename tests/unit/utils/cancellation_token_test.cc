@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "utils/cancellation_token.h"
+
+namespace koebridge {
+namespace utils {
+namespace testing {
+
+TEST(CancellationTokenTest, NoTimeoutNeverExpires) {
+    auto token = CancellationToken::withTimeout(0);
+    EXPECT_FALSE(token->shouldStop());
+    EXPECT_EQ(token->getDeadline(), CancellationToken::Clock::time_point::max());
+    EXPECT_STREQ(token->stopReason(), "");
+}
+
+TEST(CancellationTokenTest, CancelStops) {
+    auto token = CancellationToken::withTimeout(60000);
+    token->cancel();
+    EXPECT_TRUE(token->isCancelled());
+    EXPECT_FALSE(token->isExpired());
+    EXPECT_TRUE(token->shouldStop());
+    EXPECT_STREQ(token->stopReason(), "Cancelled");
+}
+
+TEST(CancellationTokenTest, DeadlineExpires) {
+    auto token = CancellationToken::withTimeout(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(token->isCancelled());
+    EXPECT_TRUE(token->isExpired());
+    EXPECT_TRUE(token->shouldStop());
+    EXPECT_STREQ(token->stopReason(), "Deadline exceeded");
+}
+
+TEST(CancellationTokenTest, ReportsFirstCancelOnly) {
+    int reported = 0;
+    CancellationToken token(CancellationToken::Clock::time_point::max(), [&reported] { ++reported; });
+    token.cancel();
+    token.cancel();
+    EXPECT_TRUE(token.isCancelled());
+    EXPECT_EQ(reported, 1);
+}
+
+TEST(CancellationTokenTest, CancelFromAnotherThread) {
+    auto token = CancellationToken::withTimeout(0);
+    std::thread canceller([token] { token->cancel(); });
+    canceller.join();
+    EXPECT_TRUE(token->shouldStop());
+}
+
+} // namespace testing
+} // namespace utils
+} // namespace koebridge
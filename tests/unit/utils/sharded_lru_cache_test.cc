@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/sharded_lru_cache.h"
+#include "utils/text_normalizer.h"
+
+namespace koebridge {
+namespace utils {
+namespace testing {
+
+using Cache = ShardedLruCache<std::string, std::vector<int>>;
+
+TEST(ShardedLruCacheTest, ReturnsStoredValue) {
+    Cache cache(64);
+    std::vector<int> value;
+    EXPECT_FALSE(cache.get("hello", value));
+
+    cache.put("hello", {1, 2, 3});
+    ASSERT_TRUE(cache.get("hello", value));
+    EXPECT_EQ(value, (std::vector<int>{1, 2, 3}));
+
+    CacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.size, 1u);
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 0.5);
+}
+
+TEST(ShardedLruCacheTest, EvictsLeastRecentlyUsed) {
+    // One entry per shard, so every key competes only with keys in its shard
+    Cache cache(Cache::kShardCount);
+    for (int i = 0; i < 1000; ++i) {
+        cache.put(std::to_string(i), {i});
+    }
+
+    CacheStats stats = cache.getStats();
+    EXPECT_LE(stats.size, Cache::kShardCount);
+    EXPECT_EQ(stats.evictions, 1000u - stats.size);
+
+    // The last key written is always the newest in its shard
+    std::vector<int> value;
+    ASSERT_TRUE(cache.get("999", value));
+    EXPECT_EQ(value, std::vector<int>{999});
+    EXPECT_FALSE(cache.get("0", value));
+}
+
+TEST(ShardedLruCacheTest, ZeroCapacityDisablesCache) {
+    Cache cache(0);
+    cache.put("hello", {1});
+    std::vector<int> value;
+    EXPECT_FALSE(cache.get("hello", value));
+    EXPECT_EQ(cache.getStats().size, 0u);
+}
+
+TEST(ShardedLruCacheTest, ConcurrentAccess) {
+    Cache cache(256);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t]() {
+            std::vector<int> value;
+            for (int i = 0; i < 2000; ++i) {
+                const std::string key = std::to_string((i * 7 + t) % 300);
+                if (!cache.get(key, value)) {
+                    cache.put(key, {i});
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.hits + stats.misses, 8000u);
+    EXPECT_LE(stats.size, 256u + Cache::kShardCount);
+}
+
+TEST(TextNormalizerTest, CollapsesWhitespace) {
+    EXPECT_EQ(normalizeWhitespace("  hello \t world\n"), "hello world");
+    EXPECT_EQ(normalizeWhitespace("\xE3\x80\x80はい\xE3\x80\x80そうですね"), "はい そうですね");
+    EXPECT_EQ(normalizeWhitespace(""), "");
+}
+
+} // namespace testing
+} // namespace utils
+} // namespace koebridge
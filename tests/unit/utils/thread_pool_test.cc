@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include "utils/thread_pool.h"
+
+namespace koebridge {
+namespace utils {
+namespace testing {
+
+TEST(ThreadPoolTest, ReturnsResults) {
+    ThreadPool pool(4);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.submit([i] { return i * i; }));
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+}
+
+TEST(ThreadPoolTest, PropagatesExceptions) {
+    ThreadPool pool(1);
+    auto future = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+
+    // The worker survives the exception
+    EXPECT_EQ(pool.submit([] { return 7; }).get(), 7);
+}
+
+TEST(ThreadPoolTest, BoundsConcurrency) {
+    ThreadPool pool(3);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 30; ++i) {
+        results.push_back(pool.submit([&] {
+            int now = ++running;
+            int seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --running;
+        }));
+    }
+    for (auto& result : results) {
+        result.get();
+    }
+    EXPECT_LE(peak.load(), 3);
+    EXPECT_EQ(pool.getThreadCount(), 3u);
+}
+
+TEST(ThreadPoolTest, TasksCanSubmitTasks) {
+    ThreadPool pool(2);
+    std::atomic<int> count{0};
+    auto outer = pool.submit([&] {
+        std::vector<std::future<void>> inner;
+        for (int i = 0; i < 10; ++i) {
+            inner.push_back(pool.submit([&] { ++count; }));
+        }
+        return inner;
+    });
+    for (auto& future : outer.get()) {
+        future.get();
+    }
+    EXPECT_EQ(count.load(), 10);
+}
+
+TEST(ThreadPoolTest, DestructorRunsQueuedTasks) {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool(1);
+        for (int i = 0; i < 20; ++i) {
+            pool.submit([&] { ++count; });
+        }
+    }
+    EXPECT_EQ(count.load(), 20);
+}
+
+} // namespace testing
+} // namespace utils
+} // namespace koebridge
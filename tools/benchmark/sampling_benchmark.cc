@@ -0,0 +1,129 @@
+/**
+ * @file sampling_benchmark.cc
+ * @brief koebridge-sampling-benchmark: time the token sampler without a forward pass
+ *
+ * Random logits of the requested vocabulary sizes are sampled with a few typical
+ * parameter sets. Each iteration restores the logits first, since the sampler
+ * rewrites them in place; only the sampler call itself is timed.
+ */
+
+#include "llm/sampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using koebridge::inference::LogitsSpan;
+using koebridge::llm::Sampler;
+using koebridge::llm::SamplingParams;
+
+namespace {
+
+/**
+ * @struct Scenario
+ * @brief A named set of sampling parameters
+ */
+struct Scenario {
+    const char* name;
+    SamplingParams params;
+};
+
+SamplingParams makeParams(float temperature, int topK, float topP, float repeatPenalty) {
+    SamplingParams params;
+    params.temperature = temperature;
+    params.topK = topK;
+    params.topP = topP;
+    params.repeatPenalty = repeatPenalty;
+    return params;
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  -v, --vocab N        Vocabulary size, repeatable (default 32000 and 256206)\n"
+              << "  -n, --iterations N   Sampling steps per scenario (default 200)\n"
+              << "  -h, --help           Show this help\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> vocabSizes;
+    int iterations = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-v" || arg == "--vocab") && i + 1 < argc) {
+            vocabSizes.push_back(std::strtoul(argv[++i], nullptr, 10));
+        } else if ((arg == "-n" || arg == "--iterations") && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (vocabSizes.empty()) {
+        vocabSizes = {32000, 256206};
+    }
+
+    const std::vector<Scenario> scenarios = {
+        {"default (k=40, p=0.9)", makeParams(0.7f, 40, 0.9f, 1.1f)},
+        {"top-k only (k=40)", makeParams(0.7f, 40, 1.0f, 1.0f)},
+        {"top-p only (p=0.9)", makeParams(0.7f, 0, 0.9f, 1.0f)},
+        {"full vocabulary", makeParams(1.0f, 0, 1.0f, 1.0f)},
+    };
+
+    std::mt19937 rng(42);
+    std::normal_distribution<float> dist(0.0f, 3.0f);
+
+    std::cout << std::left << std::setw(12) << "vocab" << std::setw(26) << "scenario"
+              << std::right << std::setw(12) << "mean us" << std::setw(12) << "p50 us"
+              << std::setw(12) << "p99 us" << std::endl;
+
+    for (size_t vocabSize : vocabSizes) {
+        std::vector<float> pristine(vocabSize);
+        for (float& logit : pristine) {
+            logit = dist(rng);
+        }
+
+        std::vector<int> history(256);
+        for (int& token : history) {
+            token = static_cast<int>(rng() % vocabSize);
+        }
+
+        std::vector<float> logits(vocabSize);
+        for (const Scenario& scenario : scenarios) {
+            Sampler sampler(scenario.params);
+            std::vector<double> timesUs;
+            timesUs.reserve(iterations);
+
+            for (int it = 0; it < iterations; ++it) {
+                std::copy(pristine.begin(), pristine.end(), logits.begin());
+
+                auto start = std::chrono::steady_clock::now();
+                volatile int token = sampler.sample(LogitsSpan(logits.data(), logits.size()), history);
+                auto end = std::chrono::steady_clock::now();
+                (void)token;
+
+                timesUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            }
+
+            std::sort(timesUs.begin(), timesUs.end());
+            double total = 0.0;
+            for (double t : timesUs) {
+                total += t;
+            }
+
+            std::cout << std::left << std::setw(12) << vocabSize << std::setw(26) << scenario.name
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << total / timesUs.size()
+                      << std::setw(12) << timesUs[timesUs.size() / 2]
+                      << std::setw(12) << timesUs[timesUs.size() * 99 / 100] << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,598 @@
+/**
+ * @file quantize.cc
+ * @brief koebridge-quantize: convert an f32 GGUF model into quantized variants
+ *
+ * Every variant gets the input's metadata, quantized weight tensors, and precomputed
+ * vocabulary lookup tables so the engine can load it with a single mmap. The SentencePiece
+ * model and per-language output shortlists can be embedded too, so a variant is
+ * self-contained. A report with
+ * size, reconstruction error and output-projection matvec speed is printed per variant.
+ */
+
+#include "inference/gguf_keys.h"
+#include <ggml.h>
+#include <ggml-cpu.h>
+#include <gguf.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace keys = koebridge::inference::gguf_keys;
+
+namespace {
+
+/**
+ * @struct TensorOverride
+ * @brief Per-tensor type selected on the command line
+ */
+struct TensorOverride {
+    std::regex pattern;
+    ggml_type type;
+};
+
+/**
+ * @struct Options
+ * @brief Command line options
+ */
+struct Options {
+    std::string input;
+    std::string outputDir = ".";
+    std::vector<ggml_type> variants;
+    std::vector<TensorOverride> overrides;
+    std::string reportPath;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int benchIterations = 20;
+    std::string tokenizerPath;
+    std::string tokenizerModel;  ///< Serialized SentencePiece model embedded in every variant
+    std::map<std::string, std::string> shortlistPaths;
+    std::map<std::string, std::vector<int32_t>> shortlists;  ///< Output token IDs per language code
+};
+
+/**
+ * @struct VariantReport
+ * @brief Accuracy, size and speed figures for one variant
+ */
+struct VariantReport {
+    std::string variant;
+    std::string path;
+    size_t fileBytes = 0;
+    size_t weightBytes = 0;
+    double relativeRmse = 0.0;
+    double maxAbsError = 0.0;
+    double matvecMs = 0.0;
+};
+
+const std::map<std::string, ggml_type> kTypeNames = {
+    {"f32", GGML_TYPE_F32},
+    {"f16", GGML_TYPE_F16},
+    {"q4_0", GGML_TYPE_Q4_0},
+    {"q4_k", GGML_TYPE_Q4_K},
+    {"q5_k", GGML_TYPE_Q5_K},
+    {"q6_k", GGML_TYPE_Q6_K},
+    {"q8_0", GGML_TYPE_Q8_0},
+};
+
+void usage(const char* program) {
+    std::cout << "Usage: " << program << " [OPTIONS] -i MODEL_F32.gguf" << std::endl
+              << std::endl
+              << "Convert an f32 GGUF model into quantized variants." << std::endl
+              << std::endl
+              << "Options:" << std::endl
+              << "  -i, --input PATH            Input f32 (or f16) GGUF model" << std::endl
+              << "  -o, --output-dir DIR        Output directory (default: .)" << std::endl
+              << "  -t, --type TYPE             Variant to produce, repeatable" << std::endl
+              << "                              (f16, q4_0, q4_k, q5_k, q6_k, q8_0)" << std::endl
+              << "      --tensor-type RE=TYPE   Override the type of tensors matching RE" << std::endl
+              << "      --tokenizer PATH        Embed a SentencePiece model in every variant" << std::endl
+              << "      --shortlist LANG=PATH   Embed the output token IDs listed in PATH for LANG," << std::endl
+              << "                              repeatable" << std::endl
+              << "  -r, --report PATH           Also write the report as CSV" << std::endl
+              << "  -j, --threads N             Threads for the speed benchmark" << std::endl
+              << "  -h, --help                  Display this help message" << std::endl;
+}
+
+bool parseType(const std::string& name, ggml_type& type) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    auto it = kTypeNames.find(lower);
+    if (it == kTypeNames.end()) {
+        return false;
+    }
+    type = it->second;
+    return true;
+}
+
+std::string typeLabel(ggml_type type) {
+    for (const auto& entry : kTypeNames) {
+        if (entry.second == type) {
+            return entry.first;
+        }
+    }
+    return ggml_type_name(type);
+}
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](std::string& value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+
+        std::string value;
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            std::exit(0);
+        } else if (arg == "-i" || arg == "--input") {
+            if (!next(options.input)) return false;
+        } else if (arg == "-o" || arg == "--output-dir") {
+            if (!next(options.outputDir)) return false;
+        } else if (arg == "--tokenizer") {
+            if (!next(options.tokenizerPath)) return false;
+        } else if (arg == "--shortlist") {
+            if (!next(value)) return false;
+            auto eq = value.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "Invalid shortlist: " << value << std::endl;
+                return false;
+            }
+            options.shortlistPaths[value.substr(0, eq)] = value.substr(eq + 1);
+        } else if (arg == "-r" || arg == "--report") {
+            if (!next(options.reportPath)) return false;
+        } else if (arg == "-j" || arg == "--threads") {
+            if (!next(value)) return false;
+            try {
+                size_t end = 0;
+                options.threads = std::max(1, std::stoi(value, &end));
+                if (end != value.size()) {
+                    throw std::invalid_argument(value);
+                }
+            } catch (const std::invalid_argument&) {
+                std::cerr << "Invalid thread count: " << value << std::endl;
+                return false;
+            } catch (const std::out_of_range&) {
+                std::cerr << "Invalid thread count: " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "-t" || arg == "--type") {
+            if (!next(value)) return false;
+            ggml_type type;
+            if (!parseType(value, type) || type == GGML_TYPE_F32) {
+                std::cerr << "Unsupported variant type: " << value << std::endl;
+                return false;
+            }
+            options.variants.push_back(type);
+        } else if (arg == "--tensor-type") {
+            if (!next(value)) return false;
+            auto eq = value.rfind('=');
+            ggml_type type;
+            if (eq == std::string::npos || !parseType(value.substr(eq + 1), type)) {
+                std::cerr << "Invalid tensor type override: " << value << std::endl;
+                return false;
+            }
+            try {
+                options.overrides.push_back({std::regex(value.substr(0, eq)), type});
+            } catch (const std::regex_error& e) {
+                std::cerr << "Invalid tensor type override: " << value << " (" << e.what() << ")" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.input.empty()) {
+        std::cerr << "No input model given" << std::endl;
+        return false;
+    }
+    if (options.variants.empty()) {
+        options.variants = {GGML_TYPE_Q8_0, GGML_TYPE_Q5_K, GGML_TYPE_Q4_K, GGML_TYPE_Q4_0};
+    }
+    return true;
+}
+
+bool isVocabTable(const std::string& name) {
+    return name == keys::kVocabBlob || name == keys::kVocabOffsets || name == keys::kVocabSorted ||
+           name == keys::kTokenizerModel || name.rfind(keys::kShortlistPrefix, 0) == 0;
+}
+
+/**
+ * @brief Read whitespace-separated token IDs
+ */
+bool readShortlist(const std::string& path, std::vector<int32_t>& ids) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    int32_t id;
+    while (file >> id) {
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return file.eof() && !ids.empty();
+}
+
+/**
+ * @brief Choose the storage type of a tensor for a variant
+ */
+ggml_type selectType(const ggml_tensor* tensor, ggml_type variant, const Options& options) {
+    const std::string name = ggml_get_name(tensor);
+
+    // Norms, biases and other vectors stay in full precision
+    if (ggml_n_dims(tensor) < 2) {
+        return GGML_TYPE_F32;
+    }
+
+    ggml_type type = variant;
+    for (const auto& override : options.overrides) {
+        if (std::regex_search(name, override.pattern)) {
+            type = override.type;
+        }
+    }
+
+    // Rows must be a whole number of quantization blocks
+    if (tensor->ne[0] % ggml_blck_size(type) != 0) {
+        type = tensor->ne[0] % ggml_blck_size(GGML_TYPE_Q8_0) == 0 ? GGML_TYPE_Q8_0 : GGML_TYPE_F16;
+    }
+    return type;
+}
+
+std::vector<float> toFloat(const ggml_tensor* tensor) {
+    std::vector<float> values(ggml_nelements(tensor));
+    if (tensor->type == GGML_TYPE_F32) {
+        std::memcpy(values.data(), tensor->data, values.size() * sizeof(float));
+    } else {
+        ggml_get_type_traits(tensor->type)->to_float(tensor->data, values.data(), values.size());
+    }
+    return values;
+}
+
+/**
+ * @brief Build the vocabulary blob, offset and sorted-ID tables from the token list
+ *
+ * The SentencePiece model and the output shortlists are added as well when given.
+ */
+void addVocabTables(ggml_context* ctx, gguf_context* out, const gguf_context* in, const Options& options) {
+    // Serialized SentencePiece model, loaded by the engine straight from the mapping
+    const std::string& tokenizerModel = options.tokenizerModel;
+    if (!tokenizerModel.empty()) {
+        ggml_tensor* model = ggml_new_tensor_1d(ctx, GGML_TYPE_I8, tokenizerModel.size());
+        ggml_set_name(model, keys::kTokenizerModel);
+        std::memcpy(model->data, tokenizerModel.data(), tokenizerModel.size());
+        gguf_add_tensor(out, model);
+    }
+
+    for (const auto& entry : options.shortlists) {
+        ggml_tensor* ids = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, entry.second.size());
+        ggml_set_name(ids, (keys::kShortlistPrefix + entry.first).c_str());
+        std::memcpy(ids->data, entry.second.data(), entry.second.size() * sizeof(int32_t));
+        gguf_add_tensor(out, ids);
+    }
+
+    const int64_t keyId = gguf_find_key(in, keys::kTokens);
+    if (keyId < 0) {
+        std::cerr << "Warning: input has no " << keys::kTokens << ", skipping vocabulary tables" << std::endl;
+        return;
+    }
+
+    const size_t nVocab = gguf_get_arr_n(in, keyId);
+    std::vector<std::string> tokens(nVocab);
+    size_t blobBytes = 0;
+    for (size_t i = 0; i < nVocab; ++i) {
+        tokens[i] = gguf_get_arr_str(in, keyId, i);
+        blobBytes += tokens[i].size();
+    }
+
+    ggml_tensor* blob = ggml_new_tensor_1d(ctx, GGML_TYPE_I8, std::max<size_t>(1, blobBytes));
+    ggml_tensor* offsets = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, nVocab + 1);
+    ggml_tensor* sorted = ggml_new_tensor_1d(ctx, GGML_TYPE_I32, nVocab);
+    ggml_set_name(blob, keys::kVocabBlob);
+    ggml_set_name(offsets, keys::kVocabOffsets);
+    ggml_set_name(sorted, keys::kVocabSorted);
+
+    char* blobData = static_cast<char*>(blob->data);
+    int32_t* offsetData = static_cast<int32_t*>(offsets->data);
+    size_t position = 0;
+    for (size_t i = 0; i < nVocab; ++i) {
+        offsetData[i] = static_cast<int32_t>(position);
+        std::memcpy(blobData + position, tokens[i].data(), tokens[i].size());
+        position += tokens[i].size();
+    }
+    offsetData[nVocab] = static_cast<int32_t>(position);
+
+    int32_t* sortedData = static_cast<int32_t*>(sorted->data);
+    for (size_t i = 0; i < nVocab; ++i) {
+        sortedData[i] = static_cast<int32_t>(i);
+    }
+    std::stable_sort(sortedData, sortedData + nVocab, [&tokens](int32_t a, int32_t b) {
+        return tokens[a] < tokens[b];
+    });
+
+    gguf_add_tensor(out, blob);
+    gguf_add_tensor(out, offsets);
+    gguf_add_tensor(out, sorted);
+}
+
+/**
+ * @brief Time a matrix-vector product with the given weight, as done once per decode step
+ */
+double benchmarkMatvec(const ggml_tensor* weight, int threads, int iterations) {
+    const size_t ctxSize = ggml_tensor_overhead() * 4 + ggml_graph_overhead() +
+        (weight->ne[0] + weight->ne[1]) * sizeof(float) + 1024 * 1024;
+    ggml_context* ctx = ggml_init({ctxSize, nullptr, false});
+    if (!ctx) {
+        return 0.0;
+    }
+
+    ggml_tensor* x = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, weight->ne[0]);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    float* xData = static_cast<float*>(x->data);
+    for (int64_t i = 0; i < weight->ne[0]; ++i) {
+        xData[i] = dist(rng);
+    }
+
+    ggml_tensor* y = ggml_mul_mat(ctx, const_cast<ggml_tensor*>(weight), x);
+    ggml_cgraph* graph = ggml_new_graph(ctx);
+    ggml_build_forward_expand(graph, y);
+
+    ggml_cplan plan = ggml_graph_plan(graph, threads, nullptr);
+    std::vector<uint8_t> work(plan.work_size);
+    plan.work_data = work.data();
+
+    ggml_graph_compute(graph, &plan); // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        ggml_graph_compute(graph, &plan);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    ggml_free(ctx);
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+bool writeVariant(const Options& options, ggml_type variant, gguf_context* in, ggml_context* weights,
+                  VariantReport& report) {
+    const fs::path inputPath(options.input);
+    std::string stem = inputPath.stem().string();
+    for (const char* suffix : {"-f32", "-F32", "_f32"}) {
+        if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, suffix) == 0) {
+            stem.resize(stem.size() - 4);
+        }
+    }
+    report.variant = typeLabel(variant);
+    report.path = (fs::path(options.outputDir) / (stem + "-" + report.variant + ".gguf")).string();
+
+    // Size the context for quantized copies of every tensor plus the vocabulary tables
+    size_t ctxSize = ggml_tensor_overhead() * 4 + 1024 * 1024;
+    const int64_t keyId = gguf_find_key(in, keys::kTokens);
+    if (keyId >= 0) {
+        const size_t nVocab = gguf_get_arr_n(in, keyId);
+        for (size_t i = 0; i < nVocab; ++i) {
+            ctxSize += std::strlen(gguf_get_arr_str(in, keyId, i));
+        }
+        ctxSize += (2 * nVocab + 1) * sizeof(int32_t);
+    }
+    ctxSize += ggml_tensor_overhead() + options.tokenizerModel.size();
+    for (const auto& entry : options.shortlists) {
+        ctxSize += ggml_tensor_overhead() + entry.second.size() * sizeof(int32_t);
+    }
+    for (ggml_tensor* t = ggml_get_first_tensor(weights); t; t = ggml_get_next_tensor(weights, t)) {
+        ctxSize += ggml_tensor_overhead() + ggml_row_size(GGML_TYPE_F32, t->ne[0]) * ggml_nrows(t);
+    }
+
+    ggml_context* ctx = ggml_init({ctxSize, nullptr, false});
+    if (!ctx) {
+        std::cerr << "Failed to allocate " << ctxSize / 1024 / 1024 << " MB for " << report.variant << std::endl;
+        return false;
+    }
+
+    gguf_context* out = gguf_init_empty();
+    gguf_set_kv(out, in);
+    gguf_set_val_u32(out, keys::kQuantizationVersion, GGML_QNT_VERSION);
+    gguf_set_val_str(out, keys::kQuantizationVariant, report.variant.c_str());
+
+    double sumSquaredError = 0.0;
+    double sumSquared = 0.0;
+    const ggml_tensor* benchWeight = nullptr;
+
+    for (ggml_tensor* src = ggml_get_first_tensor(weights); src; src = ggml_get_next_tensor(weights, src)) {
+        const std::string name = ggml_get_name(src);
+        if (isVocabTable(name)) {
+            continue;
+        }
+
+        const ggml_type type = selectType(src, variant, options);
+        ggml_tensor* dst = ggml_new_tensor(ctx, type, ggml_n_dims(src), src->ne);
+        ggml_set_name(dst, name.c_str());
+
+        std::vector<float> values = toFloat(src);
+        const int64_t nPerRow = src->ne[0];
+        const int64_t nRows = ggml_nrows(src);
+
+        if (type == GGML_TYPE_F32) {
+            std::memcpy(dst->data, values.data(), values.size() * sizeof(float));
+        } else {
+            ggml_quantize_chunk(type, values.data(), dst->data, 0, nRows, nPerRow, nullptr);
+
+            // Reconstruction error against the f32 source
+            std::vector<float> restored(values.size());
+            ggml_get_type_traits(type)->to_float(dst->data, restored.data(), restored.size());
+            for (size_t i = 0; i < values.size(); ++i) {
+                const double diff = static_cast<double>(values[i]) - restored[i];
+                sumSquaredError += diff * diff;
+                sumSquared += static_cast<double>(values[i]) * values[i];
+                report.maxAbsError = std::max(report.maxAbsError, std::abs(diff));
+            }
+        }
+
+        report.weightBytes += ggml_nbytes(dst);
+        gguf_add_tensor(out, dst);
+
+        if (name == keys::kOutput || (!benchWeight && name == keys::kTokenEmbedding)) {
+            benchWeight = dst;
+        }
+        std::cout << "  " << std::left << std::setw(48) << name << " "
+                  << std::setw(5) << typeLabel(type) << " "
+                  << ggml_nbytes(dst) / 1024 << " KB" << std::endl;
+    }
+
+    addVocabTables(ctx, out, in, options);
+
+    report.relativeRmse = sumSquared > 0.0 ? std::sqrt(sumSquaredError / sumSquared) : 0.0;
+
+    if (!gguf_write_to_file(out, report.path.c_str(), false)) {
+        std::cerr << "Failed to write " << report.path << std::endl;
+        gguf_free(out);
+        ggml_free(ctx);
+        return false;
+    }
+    report.fileBytes = fs::file_size(report.path);
+
+    if (benchWeight) {
+        report.matvecMs = benchmarkMatvec(benchWeight, options.threads, options.benchIterations);
+    }
+
+    gguf_free(out);
+    ggml_free(ctx);
+    return true;
+}
+
+void printReport(const std::vector<VariantReport>& reports, size_t baselineBytes, const std::string& csvPath) {
+    std::cout << std::endl
+              << std::left << std::setw(8) << "variant"
+              << std::right << std::setw(12) << "size (MB)"
+              << std::setw(10) << "ratio"
+              << std::setw(14) << "rel. RMSE"
+              << std::setw(14) << "max |err|"
+              << std::setw(14) << "matvec (ms)" << std::endl;
+
+    for (const auto& report : reports) {
+        const double ratio = report.fileBytes ? static_cast<double>(baselineBytes) / report.fileBytes : 0.0;
+        std::cout << std::left << std::setw(8) << report.variant
+                  << std::right << std::fixed
+                  << std::setw(12) << std::setprecision(1) << report.fileBytes / 1024.0 / 1024.0
+                  << std::setw(10) << std::setprecision(2) << ratio
+                  << std::setw(14) << std::setprecision(6) << report.relativeRmse
+                  << std::setw(14) << std::setprecision(6) << report.maxAbsError
+                  << std::setw(14) << std::setprecision(3) << report.matvecMs << std::endl;
+    }
+
+    if (csvPath.empty()) {
+        return;
+    }
+
+    std::ofstream csv(csvPath);
+    csv << "variant,path,file_bytes,weight_bytes,relative_rmse,max_abs_error,matvec_ms\n";
+    for (const auto& report : reports) {
+        csv << report.variant << "," << report.path << "," << report.fileBytes << ","
+            << report.weightBytes << "," << report.relativeRmse << "," << report.maxAbsError << ","
+            << report.matvecMs << "\n";
+    }
+    std::cout << "Report written to " << csvPath << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ggml_context* weights = nullptr;
+    gguf_init_params params = {false, &weights};
+    gguf_context* in = gguf_init_from_file(options.input.c_str(), params);
+    if (!in) {
+        std::cerr << "Failed to read GGUF model: " << options.input << std::endl;
+        return 1;
+    }
+
+    for (ggml_tensor* t = ggml_get_first_tensor(weights); t; t = ggml_get_next_tensor(weights, t)) {
+        if (t->type != GGML_TYPE_F32 && t->type != GGML_TYPE_F16 && !isVocabTable(ggml_get_name(t))) {
+            std::cerr << "Input tensor " << ggml_get_name(t) << " is already " << ggml_type_name(t->type)
+                      << "; quantize from an f32 or f16 model" << std::endl;
+            gguf_free(in);
+            ggml_free(weights);
+            return 1;
+        }
+    }
+
+    // An explicit tokenizer wins over one already embedded in the input
+    if (!options.tokenizerPath.empty()) {
+        std::ifstream file(options.tokenizerPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to read tokenizer model: " << options.tokenizerPath << std::endl;
+            gguf_free(in);
+            ggml_free(weights);
+            return 1;
+        }
+        options.tokenizerModel.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else if (ggml_tensor* embedded = ggml_get_tensor(weights, keys::kTokenizerModel)) {
+        options.tokenizerModel.assign(static_cast<const char*>(embedded->data), ggml_nbytes(embedded));
+    }
+
+    // Shortlists already in the input are kept unless replaced on the command line
+    for (ggml_tensor* t = ggml_get_first_tensor(weights); t; t = ggml_get_next_tensor(weights, t)) {
+        const std::string name = ggml_get_name(t);
+        if (t->type == GGML_TYPE_I32 && name.rfind(keys::kShortlistPrefix, 0) == 0) {
+            const int32_t* data = static_cast<const int32_t*>(t->data);
+            options.shortlists[name.substr(std::strlen(keys::kShortlistPrefix))].assign(data, data + ggml_nelements(t));
+        }
+    }
+    for (const auto& entry : options.shortlistPaths) {
+        std::vector<int32_t> ids;
+        if (!readShortlist(entry.second, ids)) {
+            std::cerr << "Failed to read shortlist for " << entry.first << ": " << entry.second << std::endl;
+            gguf_free(in);
+            ggml_free(weights);
+            return 1;
+        }
+        options.shortlists[entry.first] = std::move(ids);
+    }
+
+    fs::create_directories(options.outputDir);
+    for (ggml_type variant : options.variants) {
+        ggml_quantize_init(variant);
+    }
+
+    std::vector<VariantReport> reports;
+    for (ggml_type variant : options.variants) {
+        std::cout << "Writing " << typeLabel(variant) << " variant..." << std::endl;
+        VariantReport report;
+        if (!writeVariant(options, variant, in, weights, report)) {
+            gguf_free(in);
+            ggml_free(weights);
+            return 1;
+        }
+        reports.push_back(report);
+    }
+
+    printReport(reports, fs::file_size(options.input), options.reportPath);
+
+    gguf_free(in);
+    ggml_free(weights);
+    return 0;
+}